@@ -14,6 +14,9 @@
 #include <dialogs/dialogs.h>
 #include <notification/notification_messages.h>
 
+#include "mykey_pipeline.h"
+#include "mykey_trace.h"
+
 #define TAG "COGSMyKai"
 
 // SRIX4K Constants
@@ -22,6 +25,16 @@
 #define SRIX4K_BLOCKS 128
 #define SRIX4K_BYTES 512
 
+#define MYKEY_APP_FOLDER "/ext/apps_data/cogs_mikai"
+#define MYKEY_DEBUG_LOG_HASHES 8
+
+// Per-scene memory budgets, exceeding them is logged and flagged in Debug Info
+#define MYKEY_MEMSTAT_RETAINED_BUDGET 1024
+#define MYKEY_MEMSTAT_STACK_BUDGET 512
+// Largest stack frame of a mykey_codec/pipeline/trace function the app runs, they
+// are called from scene and NFC worker callbacks. Checked by tests/test_budgets.py
+#define MYKEY_STACK_FRAME_BUDGET 256
+
 typedef enum {
     COGSMyKaiViewSubmenu,
     COGSMyKaiViewTextInput,
@@ -33,6 +46,7 @@ typedef enum {
 typedef enum {
     COGSMyKaiSceneStart,
     COGSMyKaiSceneRead,
+    COGSMyKaiSceneScan,
     COGSMyKaiSceneInfo,
     COGSMyKaiSceneWriteCard,
     COGSMyKaiSceneAddCredit,
@@ -45,6 +59,20 @@ typedef enum {
     COGSMyKaiSceneCount,
 } COGSMyKaiScene;
 
+// Custom events of every scene, numbered above the Start submenu indexes. Readers and
+// timers send them from other threads, one queued as its scene exits reaches the scene
+// below, which must not take it for a menu choice
+typedef enum {
+    COGSMyKaiCustomEventMenuSelected = 0x100, // Start: item index in the scene state
+    COGSMyKaiCustomEventPopupClosed,
+    COGSMyKaiCustomEventTextInput,
+    COGSMyKaiCustomEventReadProgress,
+    COGSMyKaiCustomEventReadDone,
+    COGSMyKaiCustomEventReadFailed,
+    COGSMyKaiCustomEventReadTimeout,
+    COGSMyKaiCustomEventScanCard,
+} COGSMyKaiCustomEvent;
+
 typedef struct {
     uint32_t eeprom[SRIX4K_BLOCKS];
     uint64_t uid;
@@ -55,6 +83,97 @@ typedef struct {
     uint16_t current_credit;
 } MyKeyData;
 
+// On-disk dump formats understood by mykey_load_file
+typedef enum {
+    MyKeyFileFormatUnknown,
+    MyKeyFileFormatV1, // COGES_MYKEY_V1 (Save to File)
+    MyKeyFileFormatRaw, // MyKey Raw Data Dump (mykey_save_raw_data)
+    MyKeyFileFormatDebug, // mykey_debug_*.txt (Debug Info)
+} MyKeyFileFormat;
+
+typedef enum {
+    MyKeyDebugLogWritten,
+    MyKeyDebugLogDuplicate,
+    MyKeyDebugLogDisabled,
+    MyKeyDebugLogError,
+} MyKeyDebugLogResult;
+
+// Opt-in append-only debug log, deduplicated by dump hash
+typedef struct {
+    bool enabled; // Saved in the settings file
+    bool seeded;
+    uint8_t hash_count;
+    uint8_t hash_next;
+    uint32_t hashes[MYKEY_DEBUG_LOG_HASHES];
+} MyKeyDebugLog;
+
+// Kept across launches in MYKEY_APP_FOLDER
+typedef struct {
+    bool debug_log;
+} MyKeySettings;
+
+// Progressive card reader on the asynchronous ST25TB poller
+typedef struct MyKeyReader MyKeyReader;
+
+typedef enum {
+    MyKeyReaderEventProgress, // More blocks decoded, see mykey_reader_get_card
+    MyKeyReaderEventDone, // Every block of the read mode is in
+    MyKeyReaderEventFailed, // A card session ended without completing the read
+} MyKeyReaderEvent;
+
+typedef void (*MyKeyReaderCallback)(MyKeyReaderEvent event, void* context);
+
+typedef struct {
+    uint16_t blocks_read; // Fetched from the card, the rest came from the baseline
+    uint16_t blocks_changed; // Fetched blocks that differ from the baseline
+    uint16_t blocks_planned; // To fetch in all, an incremental read settles it at its markers
+    bool incremental;
+} MyKeyReaderStatus;
+
+typedef enum {
+    MyKeyMemStatBeforeEnter,
+    MyKeyMemStatAfterEnter,
+    MyKeyMemStatBeforeExit,
+    MyKeyMemStatAfterExit,
+} MyKeyMemStatPoint;
+
+// Heap and stack watermarks sampled around each scene's enter/exit
+typedef struct {
+    uint16_t visits;
+    int32_t retained; // Heap not given back by the last visit
+    uint32_t min_free_heap;
+    // The thread's stack high-water mark only ever moves down. A visit that moved it
+    // measured this scene, one that did not only shows it stayed above the mark
+    uint32_t stack_free; // Lowest mark a visit set, else the lowest one it ran under
+    bool stack_measured; // Some visit moved the mark, stack_free is this scene's own
+    uint32_t enter_free_heap;
+    uint32_t enter_min_heap;
+    uint32_t enter_stack_free;
+} MyKeyMemStat;
+
+// Read strategies compared by the RF energy accounting
+typedef enum {
+    MyKeyEnergyModeFull,
+    MyKeyEnergyModeIncremental,
+    MyKeyEnergyModeScan, // Continuous tap-to-view
+    MyKeyEnergyModeCount,
+} MyKeyEnergyMode;
+
+// RF field-on time and battery drain of one read mode, summed over reader sessions
+typedef struct {
+    uint16_t sessions; // Reader start to stop
+    uint16_t reads; // Completed reads
+    uint32_t field_on_ms; // Poller running, field up or polling
+    uint32_t read_us; // Card detection to read complete
+    // The gauge measures the whole system, currents below are above the idle draw
+    // sampled before the field came up
+    uint32_t read_charge_nah; // read_us at the current sampled when each read completed
+    uint32_t charge_uah; // Field-on time at the session's average current
+    uint32_t energy_uwh; // Same, times the average battery voltage
+    uint32_t gauge_mah; // Drop of the fuel gauge's remaining capacity, idle draw included
+    uint32_t idle_ma; // Idle draw of the last session
+} MyKeyEnergyStat;
+
 typedef struct {
     Gui* gui;
     ViewDispatcher* view_dispatcher;
@@ -69,6 +188,16 @@ typedef struct {
     NotificationApp* notifications;
 
     MyKeyData mykey;
+    MyKeyReader* reader;
+    MyKeyData* reader_card; // Snapshot of the card being read, owned by read/scan scenes
+    FuriTimer* read_timer; // Read scene: no card read in time
+    uint8_t read_failures; // Read scene: card sessions that ended without a complete read
+    bool read_finished; // Read scene: read done or given up, later events are stale
+    MyKeyDebugLog debug_log;
+    bool trace_capture; // Record the NFC exchange of every read to SD
+    MyKeyTrace* trace;
+    MyKeyMemStat mem_stats[COGSMyKaiSceneCount];
+    MyKeyEnergyStat energy_stats[MyKeyEnergyModeCount];
     char text_buffer[32];
     uint32_t temp_credit_value; 
 } COGSMyKaiApp;
@@ -82,6 +211,11 @@ void cogs_mikai_scene_read_on_enter(void* context);
 bool cogs_mikai_scene_read_on_event(void* context, SceneManagerEvent event);
 void cogs_mikai_scene_read_on_exit(void* context);
 
+void cogs_mikai_scene_scan_on_enter(void* context);
+bool cogs_mikai_scene_scan_on_event(void* context, SceneManagerEvent event);
+void cogs_mikai_scene_scan_on_exit(void* context);
+
+void cogs_mikai_scene_info_format(MyKeyData* key, FuriString* text);
 void cogs_mikai_scene_info_on_enter(void* context);
 bool cogs_mikai_scene_info_on_event(void* context, SceneManagerEvent event);
 void cogs_mikai_scene_info_on_exit(void* context);
@@ -122,8 +256,20 @@ void cogs_mikai_scene_about_on_exit(void* context);
 extern const SceneManagerHandlers cogs_mikai_scene_handlers;
 
 // MyKey operations
-bool mykey_read_from_nfc(COGSMyKaiApp* app);
 bool mykey_write_to_nfc(COGSMyKaiApp* app);
+MyKeyReader* mykey_reader_alloc(void);
+void mykey_reader_free(MyKeyReader* reader);
+void mykey_reader_start(
+    MyKeyReader* reader,
+    MyKeyReadMode mode,
+    bool continuous,
+    MyKeyReaderCallback callback,
+    void* context);
+void mykey_reader_set_baseline(MyKeyReader* reader, const MyKeyData* key);
+void mykey_reader_set_trace(MyKeyReader* reader, MyKeyTrace* trace);
+void mykey_reader_set_energy(MyKeyReader* reader, MyKeyEnergyStat* stats);
+void mykey_reader_stop(MyKeyReader* reader);
+uint32_t mykey_reader_get_card(MyKeyReader* reader, MyKeyData* key, MyKeyReaderStatus* status);
 void mykey_calculate_encryption_key(MyKeyData* key);
 bool mykey_is_reset(MyKeyData* key);
 uint16_t mykey_get_current_credit(MyKeyData* key);
@@ -135,3 +281,17 @@ void mykey_reset(MyKeyData* key);
 uint32_t mykey_get_block(MyKeyData* key, uint8_t block_num);
 void mykey_modify_block(MyKeyData* key, uint32_t block, uint8_t block_num);
 bool mykey_save_raw_data(COGSMyKaiApp* app, const char* path); 
+
+// Scene memory instrumentation
+void cogs_mikai_memstat_sample(COGSMyKaiApp* app, uint32_t scene, MyKeyMemStatPoint point);
+bool cogs_mikai_memstat_over_budget(const MyKeyMemStat* stat);
+void cogs_mikai_memstat_format(COGSMyKaiApp* app, FuriString* text);
+MyKeyEnergyMode cogs_mikai_energy_mode(MyKeyReadMode mode, bool continuous);
+void cogs_mikai_energy_format(COGSMyKaiApp* app, FuriString* text);
+
+// MyKey file I/O
+MyKeyFileFormat mykey_load_file(MyKeyData* key, const char* path);
+MyKeyDebugLogResult mykey_debug_log_append(MyKeyDebugLog* log, const MyKeyData* key);
+void mykey_settings_load(MyKeySettings* settings);
+bool mykey_settings_save(const MyKeySettings* settings);
+bool mykey_trace_save(const MyKeyTrace* trace);
@@ -55,6 +55,14 @@ static COGSMyKaiApp* cogs_mikai_app_alloc() {
     // Initialize MyKey data
     memset(&app->mykey, 0, sizeof(MyKeyData));
     app->mykey.is_loaded = false;
+    memset(&app->debug_log, 0, sizeof(MyKeyDebugLog));
+    MyKeySettings settings;
+    mykey_settings_load(&settings);
+    app->debug_log.enabled = settings.debug_log;
+    memset(app->mem_stats, 0, sizeof(app->mem_stats));
+    memset(app->energy_stats, 0, sizeof(app->energy_stats));
+    app->trace_capture = false;
+    app->trace = NULL;
 
     scene_manager_next_scene(app->scene_manager, COGSMyKaiSceneStart);
 
@@ -0,0 +1,60 @@
+#include "cogs_mikai.h"
+#include <furi.h>
+
+// Mode names for the summary, in MyKeyEnergyMode order
+static const char* const cogs_mikai_energy_mode_names[MyKeyEnergyModeCount] = {
+    "Full",
+    "Incremental",
+    "Scan",
+};
+
+MyKeyEnergyMode cogs_mikai_energy_mode(MyKeyReadMode mode, bool continuous) {
+    if(continuous) return MyKeyEnergyModeScan;
+
+    // Quick reads only run continuously, in Scan
+    return mode == MyKeyReadModeIncremental ? MyKeyEnergyModeIncremental : MyKeyEnergyModeFull;
+}
+
+void cogs_mikai_energy_format(COGSMyKaiApp* app, FuriString* text) {
+    furi_string_cat(text, "--- RF Energy (per mode) ---\n");
+
+    bool any = false;
+    for(size_t i = 0; i < MyKeyEnergyModeCount; i++) {
+        const MyKeyEnergyStat* stat = &app->energy_stats[i];
+        if(stat->sessions == 0) continue;
+        any = true;
+
+        furi_string_cat_printf(
+            text,
+            "%s: %u reads, %u sessions\n",
+            cogs_mikai_energy_mode_names[i],
+            stat->reads,
+            stat->sessions);
+        furi_string_cat_printf(
+            text,
+            " Field on %lu ms, idle %lu mA\n",
+            stat->field_on_ms,
+            stat->idle_ma);
+        furi_string_cat_printf(
+            text,
+            " Above idle: %lu uAh, %lu uWh\n",
+            stat->charge_uah,
+            stat->energy_uwh);
+        if(stat->reads > 0) {
+            uint32_t read_nah = stat->read_charge_nah / stat->reads;
+            furi_string_cat_printf(
+                text,
+                " Per read: %lu ms, %lu.%03lu uAh\n",
+                stat->read_us / stat->reads / 1000,
+                read_nah / 1000,
+                read_nah % 1000);
+        }
+        if(stat->gauge_mah > 0) {
+            furi_string_cat_printf(text, " Gauge: -%lu mAh\n", stat->gauge_mah);
+        }
+    }
+
+    if(!any) {
+        furi_string_cat(text, "No reads yet\n");
+    }
+}
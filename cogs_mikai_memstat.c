@@ -0,0 +1,107 @@
+#include "cogs_mikai.h"
+#include <furi.h>
+
+// Scene names for the summary, in COGSMyKaiScene order
+#define ADD_SCENE(prefix, name, id) #id,
+static const char* const cogs_mikai_memstat_scene_names[] = {
+#include "scenes/cogs_mikai_scene_config.c"
+};
+#undef ADD_SCENE
+
+// High-water mark: free stack at the deepest point the thread has ever reached
+static uint32_t cogs_mikai_memstat_stack_space(void) {
+    return furi_thread_get_stack_space(furi_thread_get_current_id());
+}
+
+void cogs_mikai_memstat_sample(COGSMyKaiApp* app, uint32_t scene, MyKeyMemStatPoint point) {
+    if(scene >= COGSMyKaiSceneCount) return;
+
+    MyKeyMemStat* stat = &app->mem_stats[scene];
+    uint32_t free_heap = memmgr_get_free_heap();
+    uint32_t min_heap = memmgr_get_minimum_free_heap();
+    uint32_t free_stack = cogs_mikai_memstat_stack_space();
+
+    switch(point) {
+        case MyKeyMemStatBeforeEnter:
+            stat->visits++;
+            stat->enter_free_heap = free_heap;
+            stat->enter_min_heap = min_heap;
+            stat->enter_stack_free = free_stack;
+            break;
+        case MyKeyMemStatAfterEnter:
+        case MyKeyMemStatBeforeExit:
+            break;
+        case MyKeyMemStatAfterExit:
+            // Whatever the scene allocated and did not give back
+            stat->retained = (int32_t)stat->enter_free_heap - (int32_t)free_heap;
+            // A new global low-water mark during the visit belongs to this scene
+            if(min_heap < stat->enter_min_heap) {
+                free_heap = min_heap;
+            }
+            // Same for the stack mark, a visit that left it alone went no deeper than it
+            if(free_stack < stat->enter_stack_free) {
+                if(!stat->stack_measured || free_stack < stat->stack_free) {
+                    stat->stack_free = free_stack;
+                }
+                stat->stack_measured = true;
+            } else if(!stat->stack_measured && (stat->stack_free == 0 || free_stack < stat->stack_free)) {
+                stat->stack_free = free_stack;
+            }
+            break;
+    }
+
+    if(stat->min_free_heap == 0 || free_heap < stat->min_free_heap) {
+        stat->min_free_heap = free_heap;
+    }
+
+    if(point == MyKeyMemStatAfterExit) {
+        if(stat->retained > MYKEY_MEMSTAT_RETAINED_BUDGET) {
+            FURI_LOG_W(
+                TAG,
+                "Scene %s retained %ld bytes of heap",
+                cogs_mikai_memstat_scene_names[scene],
+                stat->retained);
+        }
+        if(stat->stack_measured && stat->stack_free < MYKEY_MEMSTAT_STACK_BUDGET) {
+            FURI_LOG_W(
+                TAG,
+                "Scene %s left only %lu bytes of stack",
+                cogs_mikai_memstat_scene_names[scene],
+                stat->stack_free);
+        }
+    }
+}
+
+bool cogs_mikai_memstat_over_budget(const MyKeyMemStat* stat) {
+    return stat->visits > 0 && (stat->retained > MYKEY_MEMSTAT_RETAINED_BUDGET ||
+                                (stat->stack_measured &&
+                                 stat->stack_free < MYKEY_MEMSTAT_STACK_BUDGET));
+}
+
+void cogs_mikai_memstat_format(COGSMyKaiApp* app, FuriString* text) {
+    furi_string_cat(text, "--- Memory (per scene) ---\n");
+    furi_string_cat_printf(
+        text,
+        "Heap free: %zu (min %zu)\n",
+        memmgr_get_free_heap(),
+        memmgr_get_minimum_free_heap());
+    furi_string_cat_printf(
+        text, "Stack free at high-water mark: %lu\n", cogs_mikai_memstat_stack_space());
+    // ">=" when the scene never went below a mark an earlier scene had set
+    furi_string_cat(text, "Scene: visits heap-min kept stack-hwm\n");
+
+    for(size_t i = 0; i < COGSMyKaiSceneCount; i++) {
+        const MyKeyMemStat* stat = &app->mem_stats[i];
+        if(stat->visits == 0) continue;
+        furi_string_cat_printf(
+            text,
+            "%s%s: %u %lu %+ld %s%lu\n",
+            cogs_mikai_memstat_over_budget(stat) ? "!" : "",
+            cogs_mikai_memstat_scene_names[i],
+            stat->visits,
+            stat->min_free_heap,
+            stat->retained,
+            stat->stack_measured ? "" : ">=",
+            stat->stack_free);
+    }
+}
@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+"""
+Packed MyKey dump archive (.mykpack): many dumps in one file, memory-mapped for analysis.
+
+Layout (little-endian):
+    header   512 bytes, ARCHIVE_HEADER_DTYPE
+    images   count * 512 bytes from images_offset, 128 uint32 each in the
+             MyKeyData.eeprom layout, so every image is 512-byte aligned
+    index    count * 32 bytes from index_offset, ARCHIVE_INDEX_DTYPE, entry i
+             describes the image at its offset (images are written in index order)
+
+The UID/offset index is a trailer rather than part of the header: build() streams
+images to disk as worker chunks come back, before the dump count and so the index
+size are known. Only the fixed-size header is written last, over a placeholder,
+and it points at the index. Readers go through index_offset either way.
+
+Opening an archive maps it read-only: Archive.images is an (N, 128) uint32 view
+of the file and goes to the batch decoders (mykey_native.summarize) without a copy.
+
+Build:  python3 mykey_archive.py build -o dumps.mykpack [-j N] <dir|glob|file>...
+Info:   python3 mykey_archive.py info dumps.mykpack
+Decode: python3 parse_mykey_file.py --bulk dumps.mykpack
+"""
+
+import argparse
+import contextlib
+import mmap
+import os
+import sys
+from multiprocessing import Pool
+
+import numpy as np
+
+import mykey_native
+import parse_mykey_file
+
+ARCHIVE_MAGIC = b"MYKPACK"
+ARCHIVE_VERSION = 1
+ARCHIVE_EXTENSION = ".mykpack"
+IMAGE_SIZE = mykey_native.IMAGE_SIZE
+
+ARCHIVE_HEADER_DTYPE = np.dtype([
+    ("magic", "S8"),
+    ("version", "<u4"),
+    ("image_size", "<u4"),
+    ("count", "<u8"),
+    ("images_offset", "<u8"),
+    ("index_offset", "<u8"),
+    ("reserved", "u1", 472),
+])
+assert ARCHIVE_HEADER_DTYPE.itemsize == IMAGE_SIZE
+
+ARCHIVE_INDEX_DTYPE = np.dtype([
+    ("uid", "<u8"),
+    ("offset", "<u8"),
+    ("encryption_key", "<u4"),  # As stored in the source dump
+    ("format", "u1"),           # ARCHIVE_FORMATS code of the source dump
+    ("reserved", "u1", 11),
+])
+assert ARCHIVE_INDEX_DTYPE.itemsize == 32
+
+# Source dump formats, see parse_mykey_file.DUMP_FORMATS
+ARCHIVE_FORMATS = {"v1": 1, "raw": 2, "debug": 3}
+
+class Archive:
+    """A read-only memory-mapped .mykpack archive. Use as a context manager."""
+
+    def __init__(self, path):
+        self.path = path
+        self._file = open(path, "rb")
+        try:
+            self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+        except ValueError:
+            self._file.close()
+            raise ValueError(f"{path}: empty file")
+
+        try:
+            self._open()
+        except ValueError:
+            self.close()
+            raise
+
+    def _open(self):
+        if len(self._map) < IMAGE_SIZE:
+            raise ValueError(f"{self.path}: too short for an archive header")
+        header = np.frombuffer(self._map, dtype=ARCHIVE_HEADER_DTYPE, count=1)[0]
+        if header["magic"] != ARCHIVE_MAGIC or header["version"] != ARCHIVE_VERSION:
+            raise ValueError(f"{self.path}: not a MyKey archive (bad magic or version)")
+        if header["image_size"] != IMAGE_SIZE:
+            raise ValueError(f"{self.path}: unexpected image size {header['image_size']}")
+
+        self.count = int(header["count"])
+        images_offset = int(header["images_offset"])
+        index_offset = int(header["index_offset"])
+        if images_offset % IMAGE_SIZE or \
+                images_offset + self.count * IMAGE_SIZE > len(self._map) or \
+                index_offset + self.count * ARCHIVE_INDEX_DTYPE.itemsize > len(self._map):
+            raise ValueError(f"{self.path}: truncated archive")
+
+        # Views into the mapping, nothing is read until touched
+        self.index = np.frombuffer(self._map, dtype=ARCHIVE_INDEX_DTYPE, count=self.count,
+                                   offset=index_offset)
+        self.images = np.frombuffer(self._map, dtype="<u4", count=self.count * 128,
+                                    offset=images_offset).reshape(self.count, 128)
+        expected = images_offset + np.arange(self.count, dtype=np.uint64) * IMAGE_SIZE
+        if np.any(self.index["offset"] != expected):
+            raise ValueError(f"{self.path}: index does not match the image layout")
+        self._by_uid = None
+
+    def close(self):
+        # Views handed out keep the mapping alive until they are released
+        self.index = self.images = None
+        try:
+            self._map.close()
+        except BufferError:
+            pass
+        self._file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __len__(self):
+        return self.count
+
+    def find(self, uid):
+        """Indices of every image of a UID, in archive order"""
+        if self._by_uid is None:
+            self._by_uid = np.argsort(self.index["uid"], kind="stable")
+        uids = self.index["uid"][self._by_uid]
+        uid = np.uint64(uid)
+        start = np.searchsorted(uids, uid, side="left")
+        end = np.searchsorted(uids, uid, side="right")
+        return self._by_uid[start:end]
+
+    def summarize(self, threads=1):
+        """Decode every image through the C core straight from the mapping (SUMMARY_DTYPE array)"""
+        return mykey_native.summarize(self.images, self.index["uid"], self.index["encryption_key"], threads)
+
+def _convert_worker(filenames):
+    """Parse one chunk of dump files. Returns (entries, images bytes, errors)."""
+    entries = []
+    images = []
+    errors = []
+    for filename in filenames:
+        try:
+            for index, (fmt, uid, encryption_key, blocks) in enumerate(parse_mykey_file.read_dumps(filename)):
+                if len(blocks) != 128:
+                    name = f"{filename}#{index}" if index else filename
+                    errors.append(f"{name}: expected 128 blocks, found {len(blocks)}")
+                    continue
+                entries.append((uid, encryption_key, ARCHIVE_FORMATS[fmt]))
+                images.append([blocks[i] for i in range(128)])
+        except (OSError, ValueError) as e:
+            errors.append(f"{filename}: {e}")
+    return entries, np.array(images, dtype="<u4").tobytes(), errors
+
+def build(patterns, output, jobs=1):
+    """
+    Convert dump files (V1 saves, raw dumps, debug captures and logs) into an archive.
+    Images are streamed to disk as chunks are parsed. Returns (dump count, errors).
+    """
+    paths = parse_mykey_file.collect_paths(patterns)
+    chunk_size = parse_mykey_file.BULK_CHUNK_SIZE
+    chunks = [paths[i:i + chunk_size] for i in range(0, len(paths), chunk_size)]
+
+    index = []
+    errors = []
+    with _writing(output) as f:
+        f.write(bytes(IMAGE_SIZE))  # Header placeholder, written last
+
+        pool = Pool(min(jobs, len(chunks))) if jobs > 1 and len(chunks) > 1 else None
+        try:
+            results = pool.imap(_convert_worker, chunks) if pool else map(_convert_worker, chunks)
+            for entries, images, chunk_errors in results:
+                for uid, encryption_key, fmt in entries:
+                    index.append((uid, IMAGE_SIZE * (len(index) + 1), encryption_key, fmt))
+                f.write(images)
+                errors.extend(chunk_errors)
+        finally:
+            if pool:
+                pool.close()
+                pool.join()
+
+        table = np.zeros(len(index), dtype=ARCHIVE_INDEX_DTYPE)
+        if index:
+            uids, offsets, keys, fmts = zip(*index)
+            table["uid"] = uids
+            table["offset"] = offsets
+            table["encryption_key"] = keys
+            table["format"] = fmts
+        _finish(f, table)
+
+    return len(index), errors
+
+@contextlib.contextmanager
+def _writing(output):
+    """Write to a temporary file next to output, moved over it only once complete"""
+    temp = output + ".tmp"
+    try:
+        with open(temp, "wb") as f:
+            yield f
+        os.replace(temp, output)
+    except BaseException:
+        with contextlib.suppress(OSError):
+            os.remove(temp)
+        raise
+
+def _finish(f, table):
+    """Append the index after the images and fill in the header placeholder"""
+    index_offset = f.tell()
+    f.write(table.tobytes())
+
+    header = np.zeros(1, dtype=ARCHIVE_HEADER_DTYPE)
+    header["magic"] = ARCHIVE_MAGIC
+    header["version"] = ARCHIVE_VERSION
+    header["image_size"] = IMAGE_SIZE
+    header["count"] = len(table)
+    header["images_offset"] = IMAGE_SIZE
+    header["index_offset"] = index_offset
+    f.seek(0)
+    f.write(header.tobytes())
+
+def pack(output, uids, keys, images, fmt="raw"):
+    """Write images already in memory ((N, 128) uint32, with their UIDs and stored keys) as an archive"""
+    images = mykey_native.as_images(images)
+    table = np.zeros(len(images), dtype=ARCHIVE_INDEX_DTYPE)
+    table["uid"] = uids
+    table["offset"] = IMAGE_SIZE * (1 + np.arange(len(images), dtype=np.uint64))
+    table["encryption_key"] = keys
+    table["format"] = ARCHIVE_FORMATS[fmt]
+
+    with _writing(output) as f:
+        f.write(bytes(IMAGE_SIZE))
+        f.write(images.astype("<u4", copy=False).tobytes())
+        _finish(f, table)
+
+def main():
+    parser = argparse.ArgumentParser(description="Build and inspect packed MyKey dump archives.")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    build_parser = commands.add_parser("build", help="convert dump files into an archive")
+    build_parser.add_argument("paths", nargs="+", help="dump files, directories or globs")
+    build_parser.add_argument("-o", "--output", required=True, help=f"archive to write ({ARCHIVE_EXTENSION})")
+    build_parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="parser processes")
+
+    info_parser = commands.add_parser("info", help="show an archive's header and contents")
+    info_parser.add_argument("archive")
+
+    args = parser.parse_args()
+
+    if args.command == "build":
+        count, errors = build(args.paths, args.output, max(1, args.jobs))
+        for error in errors:
+            print(f"Warning: {error}", file=sys.stderr)
+        print(f"Packed {count} dumps into {args.output} ({len(errors)} skipped)", file=sys.stderr)
+        sys.exit(0 if count else 1)
+
+    try:
+        with Archive(args.archive) as archive:
+            formats = {code: name for name, code in ARCHIVE_FORMATS.items()}
+            counts = np.bincount(archive.index["format"], minlength=len(formats) + 1)
+            print(f"{args.archive}: {len(archive)} dumps, "
+                  f"{len(np.unique(archive.index['uid']))} distinct UIDs, "
+                  f"{len(archive) * IMAGE_SIZE // 1024} KiB of images")
+            print("Sources: " + ", ".join(f"{counts[code]} {name}" for code, name in sorted(formats.items())))
+    except (OSError, ValueError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        sys.exit(1)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,106 @@
+#include "mykey_codec.h"
+
+#define bswap32(x) __builtin_bswap32(x)
+
+const size_t mykey_codec_summary_size = sizeof(MyKeyCodecSummary);
+
+// Encryption key: UID * vendor * OTP (see mykey_calculate_encryption_key)
+uint32_t mykey_codec_encryption_key(uint64_t uid, const uint32_t* eeprom) {
+    // OTP calculation (reverse block 6 + 1, incremental. 1,2,3, etc.)
+    uint32_t otp = ~bswap32(eeprom[0x06]) + 1;
+
+    uint32_t block18 = eeprom[0x18];
+    uint32_t block19 = eeprom[0x19];
+    mykey_codec_encode_decode(&block18);
+    mykey_codec_encode_decode(&block19);
+    uint64_t vendor = (((uint64_t)block18 << 16) | (block19 & 0x0000FFFF)) + 1;
+
+    return (uid * vendor * otp) & 0xFFFFFFFF;
+}
+
+// Current credit from block 0x21 (libmikai method)
+uint16_t mykey_codec_credit(const uint32_t* eeprom, uint32_t encryption_key) {
+    uint32_t current_credit = eeprom[0x21] ^ encryption_key;
+    mykey_codec_encode_decode(&current_credit);
+    return current_credit & 0xFFFF;
+}
+
+// Reset keys carry the factory vendor blocks
+bool mykey_codec_is_reset(const uint32_t* eeprom) {
+    return eeprom[0x18] == 0x8FCD0F48 && eeprom[0x19] == 0xC0820007;
+}
+
+// Starting offset of the transaction ring (0x34-0x3B), false if unavailable
+bool mykey_codec_history_start(const uint32_t* eeprom, uint8_t* starting_offset) {
+    uint32_t block3C = eeprom[0x3C];
+    if(block3C == 0xFFFFFFFF) {
+        return false;
+    }
+
+    uint32_t decrypted_3C = block3C ^ eeprom[0x07];
+    uint32_t offset = ((decrypted_3C & 0x30000000) >> 28) | ((decrypted_3C & 0x00100000) >> 18);
+    if(offset >= 8) {
+        return false;
+    }
+
+    *starting_offset = offset;
+    return true;
+}
+
+// Credit from transaction history, 0xFFFF if unavailable
+uint16_t mykey_codec_history_credit(const uint32_t* eeprom) {
+    uint8_t starting_offset;
+    if(!mykey_codec_history_start(eeprom, &starting_offset)) {
+        return 0xFFFF;
+    }
+    return eeprom[0x34 + ((starting_offset + 8) % 8)] & 0xFFFF;
+}
+
+// Number of used slots walking the ring from its starting offset
+uint8_t mykey_codec_history_count(const uint32_t* eeprom) {
+    uint8_t starting_offset;
+    if(!mykey_codec_history_start(eeprom, &starting_offset)) {
+        return 0;
+    }
+
+    uint8_t count = 0;
+    while(count < 8 && eeprom[0x34 + ((starting_offset + count) % 8)] != 0xFFFFFFFF) {
+        count++;
+    }
+    return count;
+}
+
+void mykey_codec_decode_blocks(uint32_t* blocks, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        mykey_codec_encode_decode(&blocks[i]);
+    }
+}
+
+// keys may be NULL, then each key is derived from its UID and image
+void mykey_codec_summarize(
+    const uint32_t* images,
+    const uint64_t* uids,
+    const uint32_t* keys,
+    size_t count,
+    MyKeyCodecSummary* out) {
+    for(size_t i = 0; i < count; i++) {
+        const uint32_t* eeprom = images + i * MYKEY_CODEC_BLOCKS;
+        MyKeyCodecSummary* summary = &out[i];
+        uint8_t starting_offset;
+
+        summary->uid = uids[i];
+        summary->encryption_key = keys ? keys[i] : mykey_codec_encryption_key(uids[i], eeprom);
+        summary->serial = eeprom[0x07];
+        summary->op_count = eeprom[0x12] & 0x00FFFFFF;
+        summary->credit = mykey_codec_credit(eeprom, summary->encryption_key);
+        summary->flags = mykey_codec_is_reset(eeprom) ? MYKEY_CODEC_FLAG_RESET : 0;
+        if(mykey_codec_history_start(eeprom, &starting_offset)) {
+            summary->flags |= MYKEY_CODEC_FLAG_HISTORY;
+        }
+        summary->history_credit = mykey_codec_history_credit(eeprom);
+        summary->transactions = mykey_codec_history_count(eeprom);
+        for(size_t j = 0; j < sizeof(summary->reserved); j++) {
+            summary->reserved[j] = 0;
+        }
+    }
+}
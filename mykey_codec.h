@@ -0,0 +1,58 @@
+#pragma once
+
+// MyKey decode core. No Furi dependencies: built into the app and, on the host,
+// into libmykey_codec for mykey_native.py together with the pipeline and trace replay.
+//
+// An image is 128 host-endian uint32 words in the same layout as MyKeyData.eeprom
+// (blocks already byte-swapped to libmikai's big-endian order), 512 bytes per dump.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MYKEY_CODEC_BLOCKS 128
+
+#define MYKEY_CODEC_FLAG_RESET (1 << 0)
+#define MYKEY_CODEC_FLAG_HISTORY (1 << 1)
+
+// Per-dump decode result for the batch entry points (32 bytes, no padding)
+typedef struct {
+    uint64_t uid;
+    uint32_t encryption_key; // Key the credit was decoded with
+    uint32_t serial; // Block 0x07
+    uint32_t op_count; // Block 0x12, lower 24 bits
+    uint16_t credit; // Block 0x21
+    uint16_t history_credit; // Transaction ring, valid with MYKEY_CODEC_FLAG_HISTORY
+    uint8_t transactions; // Used slots in the transaction ring
+    uint8_t flags;
+    uint8_t reserved[6];
+} MyKeyCodecSummary;
+
+// sizeof(MyKeyCodecSummary), checked against SUMMARY_DTYPE by mykey_native.py
+extern const size_t mykey_codec_summary_size;
+
+// Encode or decode a MyKey block (XOR bit manipulation)
+static inline void mykey_codec_encode_decode(uint32_t* block) {
+    *block ^= (*block & 0x00C00000) << 6 | (*block & 0x0000C000) << 12 | (*block & 0x000000C0) << 18 |
+              (*block & 0x000C0000) >> 6 | (*block & 0x00030000) >> 12 | (*block & 0x00000300) >> 6;
+    *block ^= (*block & 0x30000000) >> 6 | (*block & 0x0C000000) >> 12 | (*block & 0x03000000) >> 18 |
+              (*block & 0x00003000) << 6 | (*block & 0x00000030) << 12 | (*block & 0x0000000C) << 6;
+    *block ^= (*block & 0x00C00000) << 6 | (*block & 0x0000C000) << 12 | (*block & 0x000000C0) << 18 |
+              (*block & 0x000C0000) >> 6 | (*block & 0x00030000) >> 12 | (*block & 0x00000300) >> 6;
+}
+
+uint32_t mykey_codec_encryption_key(uint64_t uid, const uint32_t* eeprom);
+uint16_t mykey_codec_credit(const uint32_t* eeprom, uint32_t encryption_key);
+bool mykey_codec_is_reset(const uint32_t* eeprom);
+bool mykey_codec_history_start(const uint32_t* eeprom, uint8_t* starting_offset);
+uint16_t mykey_codec_history_credit(const uint32_t* eeprom);
+uint8_t mykey_codec_history_count(const uint32_t* eeprom);
+
+// Batch entry points over count contiguous images
+void mykey_codec_decode_blocks(uint32_t* blocks, size_t count);
+void mykey_codec_summarize(
+    const uint32_t* images,
+    const uint64_t* uids,
+    const uint32_t* keys,
+    size_t count,
+    MyKeyCodecSummary* out);
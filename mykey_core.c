@@ -1,22 +1,13 @@
 #include "cogs_mikai.h"
+#include "mykey_codec.h"
 #include <furi.h>
 #include <string.h>
 #include <machine/endian.h>
 #include <storage/storage.h>
 
-// Encode or decode a MyKey block (XOR bit manipulation)
-static inline void encode_decode_block(uint32_t* block) {
-    *block ^= (*block & 0x00C00000) << 6 | (*block & 0x0000C000) << 12 | (*block & 0x000000C0) << 18 |
-              (*block & 0x000C0000) >> 6 | (*block & 0x00030000) >> 12 | (*block & 0x00000300) >> 6;
-    *block ^= (*block & 0x30000000) >> 6 | (*block & 0x0C000000) >> 12 | (*block & 0x03000000) >> 18 |
-              (*block & 0x00003000) << 6 | (*block & 0x00000030) << 12 | (*block & 0x0000000C) << 6;
-    *block ^= (*block & 0x00C00000) << 6 | (*block & 0x0000C000) << 12 | (*block & 0x000000C0) << 18 |
-              (*block & 0x000C0000) >> 6 | (*block & 0x00030000) >> 12 | (*block & 0x00000300) >> 6;
-}
-
 // Public wrapper for debug purposes
 void mykey_encode_decode_block(uint32_t* block) {
-    encode_decode_block(block);
+    mykey_codec_encode_decode(block);
 }
 
 // Calculate checksum of a generic block
@@ -50,7 +41,7 @@ static uint8_t get_current_transaction_offset(MyKeyData* key) {
 
     // Decode transaction pointer
     uint32_t current = block3C ^ (key->eeprom[0x07] & 0x00FFFFFF);
-    encode_decode_block(&current);
+    mykey_codec_encode_decode(&current);
 
     if((current & 0x00FF0000 >> 16) > 0x07) {
         // Out of range
@@ -65,47 +56,22 @@ static uint8_t get_current_transaction_offset(MyKeyData* key) {
 void mykey_calculate_encryption_key(MyKeyData* key) {
     FURI_LOG_I(TAG, "=== Encryption Key Calculation ===");
     FURI_LOG_I(TAG, "UID (as stored): 0x%016llX", key->uid);
-
-    // OTP calculation (reverse block 6 + 1, incremental. 1,2,3, etc.)
-    uint32_t block6 = key->eeprom[0x06];
-    FURI_LOG_I(TAG, "Block 0x06 raw: 0x%08lX", block6);
-
-    uint32_t block6_reversed = __bswap32(block6);
-    FURI_LOG_I(TAG, "Block 0x06 reversed: 0x%08lX", block6_reversed);
-
-    uint32_t otp = ~block6_reversed + 1;
-    FURI_LOG_I(TAG, "OTP (~reversed + 1): 0x%08lX", otp);
+    FURI_LOG_I(TAG, "Block 0x06 raw: 0x%08lX", key->eeprom[0x06]);
+    FURI_LOG_I(TAG, "Block 0x18 raw: 0x%08lX", key->eeprom[0x18]);
+    FURI_LOG_I(TAG, "Block 0x19 raw: 0x%08lX", key->eeprom[0x19]);
 
     // Encryption key calculation
     // MK = UID * VENDOR
     // SK (Encryption key) = MK * OTP
-    uint32_t block18_raw = key->eeprom[0x18];
-    uint32_t block19_raw = key->eeprom[0x19];
-    FURI_LOG_I(TAG, "Block 0x18 raw: 0x%08lX", block18_raw);
-    FURI_LOG_I(TAG, "Block 0x19 raw: 0x%08lX", block19_raw);
-
-    uint32_t block18 = block18_raw;
-    uint32_t block19 = block19_raw;
-    encode_decode_block(&block18);
-    encode_decode_block(&block19);
-    FURI_LOG_I(TAG, "Block 0x18 decoded: 0x%08lX", block18);
-    FURI_LOG_I(TAG, "Block 0x19 decoded: 0x%08lX", block19);
-
-    uint64_t vendor = (((uint64_t)block18 << 16) | (block19 & 0x0000FFFF)) + 1;
-    FURI_LOG_I(TAG, "Vendor: 0x%llX", vendor);
-
-    // Calculate encryption key: UID * vendor * OTP
     // UID is now correctly stored in big-endian format, no swapping needed
-    key->encryption_key = (key->uid * vendor * otp) & 0xFFFFFFFF;
+    key->encryption_key = mykey_codec_encryption_key(key->uid, key->eeprom);
     FURI_LOG_I(TAG, "Encryption Key: 0x%08lX", key->encryption_key);
     FURI_LOG_I(TAG, "===================================");
 }
 
 // Check if MyKey is reset (no vendor bound)
 bool mykey_is_reset(MyKeyData* key) {
-    static const uint32_t block18_reset = 0x8FCD0F48;
-    static const uint32_t block19_reset = 0xC0820007;
-    return key->eeprom[0x18] == block18_reset && key->eeprom[0x19] == block19_reset;
+    return mykey_codec_is_reset(key->eeprom);
 }
 
 // Get block value
@@ -136,44 +102,17 @@ uint16_t mykey_get_current_credit(MyKeyData* key) {
 
     FURI_LOG_I(TAG, "Encryption key: 0x%08lX", key->encryption_key);
 
-    uint32_t after_xor = block21_raw ^ key->encryption_key;
-    FURI_LOG_I(TAG, "After XOR: 0x%08lX", after_xor);
-
-    uint32_t current_credit = after_xor;
-    encode_decode_block(&current_credit);
-    FURI_LOG_I(TAG, "After encode_decode: 0x%08lX", current_credit);
-
-    uint16_t credit_lower = current_credit & 0xFFFF;
-    uint16_t credit_upper = (current_credit >> 16) & 0xFFFF;
-    FURI_LOG_I(TAG, "Lower 16 bits: %u cents (%u.%02u EUR)",
-        credit_lower, credit_lower / 100, credit_lower % 100);
-    FURI_LOG_I(TAG, "Upper 16 bits: %u cents (%u.%02u EUR)",
-        credit_upper, credit_upper / 100, credit_upper % 100);
+    uint16_t credit = mykey_codec_credit(key->eeprom, key->encryption_key);
+    FURI_LOG_I(TAG, "Credit: %u cents (%u.%02u EUR)", credit, credit / 100, credit % 100);
     FURI_LOG_I(TAG, "=========================================");
 
-    return credit_lower;
+    return credit;
 }
 
 // Get credit from transaction history (for comparison/debugging)
 uint16_t mykey_get_credit_from_history(MyKeyData* key) {
-    uint32_t block3C = key->eeprom[0x3C];
-    if(block3C == 0xFFFFFFFF) {
-        return 0xFFFF; // No history available
-    }
-
-    // Decrypt block 0x3C to get starting offset
-    uint32_t decrypted_3C = block3C ^ key->eeprom[0x07];
-    uint32_t starting_offset = ((decrypted_3C & 0x30000000) >> 28) |
-                               ((decrypted_3C & 0x00100000) >> 18);
-
-    if(starting_offset >= 8) {
-        return 0xFFFF; // Invalid offset
-    }
-
-    // Get most recent transaction (offset 8 in the circular buffer)
     // Blocks are already in big-endian format, credit is in lower 16 bits
-    uint32_t txn_block = key->eeprom[0x34 + ((starting_offset + 8) % 8)];
-    uint16_t credit = txn_block & 0xFFFF;
+    uint16_t credit = mykey_codec_history_credit(key->eeprom);
 
     FURI_LOG_D(TAG, "Credit from transaction history: %d cents", credit);
     return credit;
@@ -251,27 +190,27 @@ bool mykey_add_cents(MyKeyData* key, uint16_t cents, uint8_t day, uint8_t month,
     // Save new credit to 21 and 25
     key->eeprom[0x21] = actual_credit;
     calculate_block_checksum(&key->eeprom[0x21], 0x21);
-    encode_decode_block(&key->eeprom[0x21]);
+    mykey_codec_encode_decode(&key->eeprom[0x21]);
     key->eeprom[0x21] ^= key->encryption_key;
 
     key->eeprom[0x25] = actual_credit;
     calculate_block_checksum(&key->eeprom[0x25], 0x25);
-    encode_decode_block(&key->eeprom[0x25]);
+    mykey_codec_encode_decode(&key->eeprom[0x25]);
     key->eeprom[0x25] ^= key->encryption_key;
 
     // Save precedent credit to 23 and 27
     key->eeprom[0x23] = precedent_credit;
     calculate_block_checksum(&key->eeprom[0x23], 0x23);
-    encode_decode_block(&key->eeprom[0x23]);
+    mykey_codec_encode_decode(&key->eeprom[0x23]);
 
     key->eeprom[0x27] = precedent_credit;
     calculate_block_checksum(&key->eeprom[0x27], 0x27);
-    encode_decode_block(&key->eeprom[0x27]);
+    mykey_codec_encode_decode(&key->eeprom[0x27]);
 
     // Save transaction pointer to block 3C
     key->eeprom[0x3C] = current << 16;
     calculate_block_checksum(&key->eeprom[0x3C], 0x3C);
-    encode_decode_block(&key->eeprom[0x3C]);
+    mykey_codec_encode_decode(&key->eeprom[0x3C]);
     key->eeprom[0x3C] ^= key->eeprom[0x07] & 0x00FFFFFF;
 
     // Increment operation counter (block 0x12, lower 24 bits)
@@ -294,7 +233,7 @@ bool mykey_set_cents(MyKeyData* key, uint16_t cents, uint8_t day, uint8_t month,
 
     key->eeprom[0x21] = 0;
     calculate_block_checksum(&key->eeprom[0x21], 0x21);
-    encode_decode_block(&key->eeprom[0x21]);
+    mykey_codec_encode_decode(&key->eeprom[0x21]);
     key->eeprom[0x21] ^= key->encryption_key;
 
     // Reset transaction history and pointer (0x34-0x3C)
@@ -357,7 +296,7 @@ void mykey_reset(MyKeyData* key) {
                 current_block = (production_date & 0x0000FF00) << 8 | (production_date & 0x00FF0000) >> 8 |
                                (production_date & 0xFF000000) >> 24;
                 calculate_block_checksum(&current_block, i);
-                encode_decode_block(&current_block);
+                mykey_codec_encode_decode(&current_block);
                 break;
             }
 
@@ -386,7 +325,7 @@ void mykey_reset(MyKeyData* key) {
                 // Generic blocks
                 current_block = 0x0000FEDC;
                 calculate_block_checksum(&current_block, i);
-                encode_decode_block(&current_block);
+                mykey_codec_encode_decode(&current_block);
                 break;
 
             case 0x19:
@@ -396,7 +335,7 @@ void mykey_reset(MyKeyData* key) {
                 // Generic blocks
                 current_block = 0x00000123;
                 calculate_block_checksum(&current_block, i);
-                encode_decode_block(&current_block);
+                mykey_codec_encode_decode(&current_block);
                 break;
 
             case 0x21:
@@ -405,7 +344,7 @@ void mykey_reset(MyKeyData* key) {
                 mykey_calculate_encryption_key(key);
                 current_block = 0;
                 calculate_block_checksum(&current_block, i);
-                encode_decode_block(&current_block);
+                mykey_codec_encode_decode(&current_block);
                 current_block ^= key->encryption_key;
                 break;
 
@@ -416,7 +355,7 @@ void mykey_reset(MyKeyData* key) {
                 // Generic blocks
                 current_block = 0x00010000;
                 calculate_block_checksum(&current_block, i);
-                encode_decode_block(&current_block);
+                mykey_codec_encode_decode(&current_block);
                 break;
 
             case 0x1A:
@@ -436,7 +375,7 @@ void mykey_reset(MyKeyData* key) {
                 // Generic blocks
                 current_block = 0;
                 calculate_block_checksum(&current_block, i);
-                encode_decode_block(&current_block);
+                mykey_codec_encode_decode(&current_block);
                 break;
 
             default:
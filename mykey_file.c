@@ -0,0 +1,444 @@
+#include "cogs_mikai.h"
+#include <furi.h>
+#include <string.h>
+#include <storage/storage.h>
+#include <toolbox/saved_struct.h>
+#include <furi_hal_rtc.h>
+
+#define MYKEY_FILE_CHUNK_SIZE 64
+#define MYKEY_FILE_LINE_SIZE 80
+
+#define MYKEY_DEBUG_LOG_PATH MYKEY_APP_FOLDER "/debug.log"
+#define MYKEY_DEBUG_LOG_OLD_PATH MYKEY_APP_FOLDER "/debug.1.log"
+#define MYKEY_DEBUG_LOG_MAX_SIZE (32 * 1024)
+// Hashes of the latest records, so a new session needs not scan the log for them
+#define MYKEY_DEBUG_LOG_HASHES_PATH MYKEY_APP_FOLDER "/.debug_log_hashes"
+#define MYKEY_DEBUG_LOG_HASHES_MAGIC 0x4D
+#define MYKEY_DEBUG_LOG_HASHES_VERSION 1
+
+#define MYKEY_SETTINGS_PATH MYKEY_APP_FOLDER "/.settings"
+#define MYKEY_SETTINGS_MAGIC 0x4B
+#define MYKEY_SETTINGS_VERSION 1
+
+#define MYKEY_TRACE_FOLDER MYKEY_APP_FOLDER "/traces"
+
+// Streaming line reader, keeps only one chunk of the file in memory
+typedef struct {
+    File* file;
+    char chunk[MYKEY_FILE_CHUNK_SIZE];
+    size_t chunk_len;
+    size_t chunk_pos;
+} MyKeyLineReader;
+
+// Read next line into buf (without '\n'). Overlong lines are truncated.
+static bool mykey_file_read_line(MyKeyLineReader* reader, char* buf, size_t max_len) {
+    size_t i = 0;
+    bool got_data = false;
+
+    while(true) {
+        if(reader->chunk_pos >= reader->chunk_len) {
+            reader->chunk_len = storage_file_read(reader->file, reader->chunk, sizeof(reader->chunk));
+            reader->chunk_pos = 0;
+            if(reader->chunk_len == 0) break;
+        }
+
+        char c = reader->chunk[reader->chunk_pos++];
+        got_data = true;
+        if(c == '\n') break;
+        if(c != '\r' && i < max_len - 1) {
+            buf[i++] = c;
+        }
+    }
+
+    buf[i] = '\0';
+    return got_data;
+}
+
+static MyKeyLineReader* mykey_line_reader_alloc(Storage* storage) {
+    MyKeyLineReader* reader = malloc(sizeof(MyKeyLineReader));
+    reader->file = storage_file_alloc(storage);
+    reader->chunk_len = 0;
+    reader->chunk_pos = 0;
+    return reader;
+}
+
+static void mykey_line_reader_free(MyKeyLineReader* reader) {
+    storage_file_close(reader->file);
+    storage_file_free(reader->file);
+    free(reader);
+}
+
+// Manual hex parser (sscanf %X doesn't work reliably on Flipper)
+static bool parse_hex(const char* str, size_t max_digits, uint64_t* value) {
+    if(!str || !value) return false;
+    *value = 0;
+    size_t i = 0;
+    for(; str[i] != '\0' && i < max_digits; i++) {
+        char c = str[i];
+        uint8_t digit;
+        if(c >= '0' && c <= '9') digit = c - '0';
+        else if(c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+        else if(c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else break;
+        *value = (*value << 4) | digit;
+    }
+    return i > 0;
+}
+
+static bool parse_hex32(const char* str, uint32_t* value) {
+    uint64_t tmp;
+    if(!parse_hex(str, 8, &tmp)) return false;
+    *value = (uint32_t)tmp;
+    return true;
+}
+
+static bool parse_dec(const char* str, uint32_t* value) {
+    *value = 0;
+    size_t i = 0;
+    for(; str[i] >= '0' && str[i] <= '9' && i < 9; i++) {
+        *value = *value * 10 + (str[i] - '0');
+    }
+    return i > 0;
+}
+
+static bool starts_with(const char* str, const char* prefix) {
+    return strncmp(str, prefix, strlen(prefix)) == 0;
+}
+
+// Identify a dump format from its first line
+static MyKeyFileFormat mykey_file_sniff(const char* first_line) {
+    if(starts_with(first_line, "COGES_MYKEY_V1")) return MyKeyFileFormatV1;
+    if(starts_with(first_line, "MyKey Raw Data Dump")) return MyKeyFileFormatRaw;
+    if(starts_with(first_line, "=== DEBUG INFO ===")) return MyKeyFileFormatDebug;
+    return MyKeyFileFormatUnknown;
+}
+
+// Parse one block line. V1: "BLOCK_033: XXXXXXXX", raw/debug: "Block 0x21: 0xXXXXXXXX"
+static bool mykey_file_parse_block(
+    MyKeyFileFormat format,
+    const char* line,
+    uint32_t* block_num,
+    uint32_t* value) {
+    const char* value_str;
+
+    if(format == MyKeyFileFormatV1) {
+        if(!starts_with(line, "BLOCK_") || !parse_dec(line + 6, block_num)) return false;
+        value_str = strstr(line, ": ");
+        if(!value_str) return false;
+        value_str += 2;
+    } else {
+        if(!starts_with(line, "Block 0x") || !parse_hex32(line + 8, block_num)) return false;
+        value_str = strstr(line, ": 0x");
+        if(!value_str) return false;
+        value_str += 4;
+    }
+
+    return *block_num < SRIX4K_BLOCKS && parse_hex32(value_str, value);
+}
+
+MyKeyFileFormat mykey_load_file(MyKeyData* key, const char* path) {
+    MyKeyFileFormat format = MyKeyFileFormatUnknown;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    MyKeyLineReader* reader = mykey_line_reader_alloc(storage);
+
+    // Parse into a scratch copy so a bad file never clobbers the loaded card
+    MyKeyData* parsed = malloc(sizeof(MyKeyData));
+    memset(parsed, 0, sizeof(MyKeyData));
+    char line[MYKEY_FILE_LINE_SIZE];
+
+    if(storage_file_open(reader->file, path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+       mykey_file_read_line(reader, line, sizeof(line))) {
+        format = mykey_file_sniff(line);
+    }
+
+    if(format != MyKeyFileFormatUnknown) {
+        uint32_t seen[SRIX4K_BLOCKS / 32] = {0};
+        size_t block_count = 0;
+        bool has_uid = false;
+        bool has_key = false;
+        // Debug captures list a few key blocks before the dump, only trust the dump itself
+        bool in_blocks = format != MyKeyFileFormatDebug;
+
+        while(block_count < SRIX4K_BLOCKS && mykey_file_read_line(reader, line, sizeof(line))) {
+            uint32_t block_num;
+            uint32_t value;
+            uint64_t uid;
+
+            if(!has_uid && starts_with(line, "UID: ") && parse_hex(line + 5, 16, &uid)) {
+                parsed->uid = uid;
+                has_uid = true;
+            } else if(
+                !has_key && starts_with(line, "ENCRYPTION_KEY: ") &&
+                parse_hex32(line + 16, &parsed->encryption_key)) {
+                has_key = true;
+            } else if(
+                !has_key && starts_with(line, "Encryption Key: 0x") &&
+                parse_hex32(line + 18, &parsed->encryption_key)) {
+                has_key = true;
+            } else if(starts_with(line, "--- Raw Data Dump ---")) {
+                in_blocks = true;
+            } else if(in_blocks && mykey_file_parse_block(format, line, &block_num, &value)) {
+                if(!(seen[block_num / 32] & (1UL << (block_num % 32)))) {
+                    seen[block_num / 32] |= 1UL << (block_num % 32);
+                    block_count++;
+                }
+                parsed->eeprom[block_num] = value;
+            }
+        }
+
+        if(has_uid && has_key && block_count == SRIX4K_BLOCKS) {
+            memcpy(key->eeprom, parsed->eeprom, sizeof(key->eeprom));
+            key->uid = parsed->uid;
+            key->encryption_key = parsed->encryption_key;
+            FURI_LOG_I(TAG, "Loaded %s (format %d), UID: %016llX", path, format, key->uid);
+        } else {
+            FURI_LOG_E(
+                TAG,
+                "Incomplete dump %s: uid=%d key=%d blocks=%zu",
+                path,
+                has_uid,
+                has_key,
+                block_count);
+            format = MyKeyFileFormatUnknown;
+        }
+    } else {
+        FURI_LOG_E(TAG, "Unknown dump format: %s", path);
+    }
+
+    free(parsed);
+    mykey_line_reader_free(reader);
+    furi_record_close(RECORD_STORAGE);
+
+    return format;
+}
+
+// FNV-1a over UID and all blocks, identifies identical dumps in the debug log
+static uint32_t mykey_dump_hash(const MyKeyData* key) {
+    uint32_t hash = 2166136261UL;
+    const uint8_t* data = (const uint8_t*)&key->uid;
+    for(size_t i = 0; i < sizeof(key->uid); i++) {
+        hash = (hash ^ data[i]) * 16777619UL;
+    }
+    data = (const uint8_t*)key->eeprom;
+    for(size_t i = 0; i < sizeof(key->eeprom); i++) {
+        hash = (hash ^ data[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+static bool mykey_debug_log_has_hash(const MyKeyDebugLog* log, uint32_t hash) {
+    for(size_t i = 0; i < log->hash_count; i++) {
+        if(log->hashes[i] == hash) return true;
+    }
+    return false;
+}
+
+static void mykey_debug_log_remember(MyKeyDebugLog* log, uint32_t hash) {
+    log->hashes[log->hash_next] = hash;
+    log->hash_next = (log->hash_next + 1) % MYKEY_DEBUG_LOG_HASHES;
+    if(log->hash_count < MYKEY_DEBUG_LOG_HASHES) log->hash_count++;
+}
+
+// Sidecar of the debug log: its latest hashes, valid for the log size they were
+// saved at. A log edited, deleted or rotated outside the app has another size.
+typedef struct {
+    uint64_t log_size;
+    uint8_t hash_count;
+    uint8_t hash_next;
+    uint32_t hashes[MYKEY_DEBUG_LOG_HASHES];
+} MyKeyDebugLogHashes;
+
+static uint64_t mykey_debug_log_size(Storage* storage) {
+    FileInfo info;
+    if(storage_common_stat(storage, MYKEY_DEBUG_LOG_PATH, &info) != FSE_OK) return 0;
+    return info.size;
+}
+
+// Pick up the hashes of the most recent records left by earlier sessions
+static void mykey_debug_log_seed(MyKeyDebugLog* log, Storage* storage) {
+    MyKeyDebugLogHashes saved;
+    uint64_t log_size = mykey_debug_log_size(storage);
+
+    if(log_size > 0 &&
+       saved_struct_load(
+           MYKEY_DEBUG_LOG_HASHES_PATH,
+           &saved,
+           sizeof(saved),
+           MYKEY_DEBUG_LOG_HASHES_MAGIC,
+           MYKEY_DEBUG_LOG_HASHES_VERSION) &&
+       saved.log_size == log_size && saved.hash_count <= MYKEY_DEBUG_LOG_HASHES &&
+       saved.hash_next < MYKEY_DEBUG_LOG_HASHES) {
+        log->hash_count = saved.hash_count;
+        log->hash_next = saved.hash_next;
+        memcpy(log->hashes, saved.hashes, sizeof(log->hashes));
+    }
+    // Otherwise start empty, at worst one dump already in the log is logged again
+    log->seeded = true;
+}
+
+static void mykey_debug_log_save_hashes(const MyKeyDebugLog* log, Storage* storage) {
+    MyKeyDebugLogHashes saved = {
+        .log_size = mykey_debug_log_size(storage),
+        .hash_count = log->hash_count,
+        .hash_next = log->hash_next,
+    };
+    memcpy(saved.hashes, log->hashes, sizeof(saved.hashes));
+    if(!saved_struct_save(
+           MYKEY_DEBUG_LOG_HASHES_PATH,
+           &saved,
+           sizeof(saved),
+           MYKEY_DEBUG_LOG_HASHES_MAGIC,
+           MYKEY_DEBUG_LOG_HASHES_VERSION)) {
+        FURI_LOG_W(TAG, "Failed to save debug log hashes");
+    }
+}
+
+// Keep one previous generation once the log reaches its size cap
+static void mykey_debug_log_rotate(Storage* storage, size_t incoming) {
+    FileInfo info;
+    if(storage_common_stat(storage, MYKEY_DEBUG_LOG_PATH, &info) != FSE_OK) return;
+    if(info.size + incoming <= MYKEY_DEBUG_LOG_MAX_SIZE) return;
+
+    storage_common_remove(storage, MYKEY_DEBUG_LOG_OLD_PATH);
+    storage_common_rename(storage, MYKEY_DEBUG_LOG_PATH, MYKEY_DEBUG_LOG_OLD_PATH);
+    FURI_LOG_I(TAG, "Debug log rotated");
+}
+
+MyKeyDebugLogResult mykey_debug_log_append(MyKeyDebugLog* log, const MyKeyData* key) {
+    if(!log->enabled) return MyKeyDebugLogDisabled;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    if(!log->seeded) {
+        mykey_debug_log_seed(log, storage);
+    }
+
+    uint32_t hash = mykey_dump_hash(key);
+    if(mykey_debug_log_has_hash(log, hash)) {
+        furi_record_close(RECORD_STORAGE);
+        FURI_LOG_D(TAG, "Dump %08lX already in debug log", hash);
+        return MyKeyDebugLogDuplicate;
+    }
+
+    // One record in the raw dump format, so the log loads like any raw dump
+    DateTime datetime;
+    furi_hal_rtc_get_datetime(&datetime);
+    FuriString* record = furi_string_alloc();
+    furi_string_printf(record, "MyKey Raw Data Dump\n");
+    furi_string_cat_printf(
+        record,
+        "Logged: %04d-%02d-%02d %02d:%02d:%02d\n",
+        datetime.year,
+        datetime.month,
+        datetime.day,
+        datetime.hour,
+        datetime.minute,
+        datetime.second);
+    furi_string_cat_printf(record, "Hash: %08lX\n", hash);
+    furi_string_cat_printf(record, "UID: %016llX\n", (unsigned long long)key->uid);
+    furi_string_cat_printf(record, "Encryption Key: 0x%08lX\n\n", key->encryption_key);
+    for(size_t i = 0; i < SRIX4K_BLOCKS; i++) {
+        furi_string_cat_printf(record, "Block 0x%02zX: 0x%08lX\n", i, key->eeprom[i]);
+    }
+    furi_string_cat(record, "\n");
+
+    storage_simply_mkdir(storage, MYKEY_APP_FOLDER);
+    mykey_debug_log_rotate(storage, furi_string_size(record));
+
+    MyKeyDebugLogResult result = MyKeyDebugLogError;
+    File* file = storage_file_alloc(storage);
+    if(storage_file_open(file, MYKEY_DEBUG_LOG_PATH, FSAM_WRITE, FSOM_OPEN_APPEND)) {
+        // Single write for the whole record
+        size_t size = furi_string_size(record);
+        if(storage_file_write(file, furi_string_get_cstr(record), size) == size) {
+            mykey_debug_log_remember(log, hash);
+            result = MyKeyDebugLogWritten;
+            FURI_LOG_I(TAG, "Dump %08lX appended to debug log", hash);
+        }
+        storage_file_close(file);
+    }
+
+    if(result == MyKeyDebugLogError) {
+        FURI_LOG_E(TAG, "Failed to append to debug log");
+    }
+
+    storage_file_free(file);
+    furi_string_free(record);
+    if(result == MyKeyDebugLogWritten) {
+        mykey_debug_log_save_hashes(log, storage);
+    }
+    furi_record_close(RECORD_STORAGE);
+
+    return result;
+}
+
+// Defaults when there is no settings file yet, or an older one
+void mykey_settings_load(MyKeySettings* settings) {
+    if(!saved_struct_load(
+           MYKEY_SETTINGS_PATH,
+           settings,
+           sizeof(MyKeySettings),
+           MYKEY_SETTINGS_MAGIC,
+           MYKEY_SETTINGS_VERSION)) {
+        memset(settings, 0, sizeof(MyKeySettings));
+    }
+}
+
+bool mykey_settings_save(const MyKeySettings* settings) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_mkdir(storage, MYKEY_APP_FOLDER);
+    furi_record_close(RECORD_STORAGE);
+
+    bool saved = saved_struct_save(
+        MYKEY_SETTINGS_PATH,
+        settings,
+        sizeof(MyKeySettings),
+        MYKEY_SETTINGS_MAGIC,
+        MYKEY_SETTINGS_VERSION);
+    if(!saved) {
+        FURI_LOG_E(TAG, "Failed to save settings");
+    }
+    return saved;
+}
+
+// Write a recorded exchange to MYKEY_TRACE_FOLDER, named after the time it is saved
+bool mykey_trace_save(const MyKeyTrace* trace) {
+    DateTime datetime;
+    furi_hal_rtc_get_datetime(&datetime);
+    FuriString* path = furi_string_alloc();
+    furi_string_printf(
+        path,
+        MYKEY_TRACE_FOLDER "/%04d%02d%02d-%02d%02d%02d" MYKEY_TRACE_EXTENSION,
+        datetime.year,
+        datetime.month,
+        datetime.day,
+        datetime.hour,
+        datetime.minute,
+        datetime.second);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_mkdir(storage, MYKEY_APP_FOLDER);
+    storage_simply_mkdir(storage, MYKEY_TRACE_FOLDER);
+
+    bool success = false;
+    File* file = storage_file_alloc(storage);
+    if(storage_file_open(file, furi_string_get_cstr(path), FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        // Header and records are contiguous in MyKeyTrace
+        size_t size = mykey_trace_size(trace);
+        success = storage_file_write(file, trace, size) == size;
+        storage_file_close(file);
+    }
+
+    if(success) {
+        FURI_LOG_I(
+            TAG, "Trace of %lu ops saved to %s", trace->header.count, furi_string_get_cstr(path));
+    } else {
+        FURI_LOG_E(TAG, "Failed to save trace to %s", furi_string_get_cstr(path));
+    }
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(path);
+
+    return success;
+}
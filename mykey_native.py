@@ -0,0 +1,282 @@
+#!/usr/bin/env python3
+"""
+ctypes binding over the C decode core (mykey_codec.c), read pipeline (mykey_pipeline.c)
+and trace replay (mykey_trace.c), the same code the Flipper app runs.
+
+The shared library is built on first use next to this file:
+    cc -O2 -shared -fPIC -o libmykey_codec.so mykey_codec.c mykey_pipeline.c mykey_trace.c
+or taken from $MYKEY_CODEC_LIB. ctypes drops the GIL for the duration of every
+foreign call, so batches split across threads decode in parallel.
+
+Images are (N, 128) uint32 arrays (or any buffer of N * 512 bytes) in the
+MyKeyData.eeprom layout.
+"""
+
+import ctypes
+import os
+import subprocess
+import tempfile
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SOURCES = [os.path.join(HERE, name) for name in ("mykey_codec.c", "mykey_pipeline.c", "mykey_trace.c")]
+# Struct layouts and inline code the sources compile in, a change rebuilds the library
+HEADERS = [os.path.join(HERE, name) for name in ("mykey_codec.h", "mykey_pipeline.h", "mykey_trace.h")]
+LIBRARY = os.environ.get("MYKEY_CODEC_LIB", os.path.join(HERE, "libmykey_codec.so"))
+
+BLOCKS = 128
+IMAGE_SIZE = BLOCKS * 4
+FLAG_RESET = 1 << 0
+FLAG_HISTORY = 1 << 1
+
+# Mirrors MyKeyCodecSummary in mykey_codec.h
+SUMMARY_DTYPE = np.dtype([
+    ("uid", "<u8"),
+    ("encryption_key", "<u4"),
+    ("serial", "<u4"),
+    ("op_count", "<u4"),
+    ("credit", "<u2"),
+    ("history_credit", "<u2"),
+    ("transactions", "u1"),
+    ("flags", "u1"),
+    ("reserved", "u1", 6),
+])
+assert SUMMARY_DTYPE.itemsize == 32
+
+# MyKeyReadMode
+READ_MODES = {"full": 0, "quick": 1, "incremental": 2}
+
+# Mirrors MyKeyTraceHeader / MyKeyTraceRecord in mykey_trace.h
+TRACE_MAGIC = b"MKTR"
+TRACE_VERSION = 1
+TRACE_HEADER_DTYPE = np.dtype([
+    ("magic", "S4"),
+    ("version", "u1"),
+    ("mode", "u1"),
+    ("record_size", "u1"),
+    ("flags", "u1"),
+    ("count", "<u4"),
+    ("reserved", "<u4"),
+])
+TRACE_RECORD_DTYPE = np.dtype([
+    ("op", "u1"),
+    ("arg", "u1"),
+    ("error", "u1"),
+    ("reserved", "u1"),
+    ("time_us", "<u4"),
+    ("data", "<u8"),
+])
+TRACE_OPS = ("detect", "read", "absent", "done", "power")
+TRACE_FLAG_TRUNCATED = 1 << 0
+TRACE_FLAG_BASELINE = 1 << 1
+
+class _Pipeline(ctypes.Structure):
+    """MyKeyPipeline in mykey_pipeline.h"""
+    _fields_ = [
+        ("uid", ctypes.c_uint64),
+        ("eeprom", ctypes.c_uint32 * BLOCKS),
+        ("present", ctypes.c_uint32 * (BLOCKS // 32)),
+        ("block_count", ctypes.c_uint16),
+        ("changed_count", ctypes.c_uint16),
+        ("baseline", ctypes.c_void_p),
+        ("encryption_key", ctypes.c_uint32),
+        ("credit", ctypes.c_uint16),
+        ("stages", ctypes.c_uint32),
+    ]
+
+class _Replay(ctypes.Structure):
+    """MyKeyTraceReplay in mykey_trace.h"""
+    _fields_ = [
+        ("uid", ctypes.c_uint64),
+        ("recorded_done", ctypes.c_bool),
+        ("done", ctypes.c_bool),
+        ("sessions", ctypes.c_uint32),
+        ("reads", ctypes.c_uint32),
+        ("read_errors", ctypes.c_uint32),
+        ("missing", ctypes.c_uint32),
+        ("recorded_us", ctypes.c_uint32),
+        ("estimated_us", ctypes.c_uint32),
+        ("current_ma", ctypes.c_uint32),
+        ("voltage_mv", ctypes.c_uint32),
+    ]
+
+_lib = None
+
+def _build():
+    """Compile the shared library if missing or older than any C source or header"""
+    if "MYKEY_CODEC_LIB" in os.environ:
+        return
+    if os.path.exists(LIBRARY) and all(os.path.getmtime(LIBRARY) >= os.path.getmtime(source)
+                                       for source in SOURCES + HEADERS):
+        return
+    # Build beside the target and rename into place, a concurrent loader never
+    # sees a half-written library
+    cc = os.environ.get("CC", "cc")
+    fd, temp = tempfile.mkstemp(suffix=".so", dir=os.path.dirname(LIBRARY))
+    os.close(fd)
+    try:
+        subprocess.run([cc, "-O2", "-shared", "-fPIC", "-o", temp] + SOURCES, check=True)
+        os.replace(temp, LIBRARY)
+    finally:
+        if os.path.exists(temp):
+            os.unlink(temp)
+
+def load():
+    """Load (building if needed) the native library, raises OSError if unavailable"""
+    global _lib
+    if _lib is not None:
+        return _lib
+
+    try:
+        _build()
+    except (OSError, subprocess.CalledProcessError) as e:
+        raise OSError(f"cannot build {LIBRARY}: {e}")
+
+    lib = ctypes.CDLL(LIBRARY)
+    u32p = ctypes.POINTER(ctypes.c_uint32)
+    u64p = ctypes.POINTER(ctypes.c_uint64)
+
+    lib.mykey_codec_decode_blocks.argtypes = [u32p, ctypes.c_size_t]
+    lib.mykey_codec_decode_blocks.restype = None
+    lib.mykey_codec_summarize.argtypes = [u32p, u64p, u32p, ctypes.c_size_t, ctypes.c_void_p]
+    lib.mykey_codec_summarize.restype = None
+    lib.mykey_codec_encryption_key.argtypes = [ctypes.c_uint64, u32p]
+    lib.mykey_codec_encryption_key.restype = ctypes.c_uint32
+    lib.mykey_trace_replay.argtypes = [
+        ctypes.c_char_p, ctypes.c_size_t, ctypes.c_int, u32p, ctypes.c_uint64,
+        ctypes.POINTER(_Pipeline), ctypes.POINTER(_Replay)]
+    lib.mykey_trace_replay.restype = ctypes.c_bool
+
+    # The ctypes and numpy mirrors must match the C layouts they are passed as
+    mirrors = (("_Pipeline", ctypes.sizeof(_Pipeline), "mykey_trace_pipeline_size"),
+               ("_Replay", ctypes.sizeof(_Replay), "mykey_trace_replay_size"),
+               ("SUMMARY_DTYPE", SUMMARY_DTYPE.itemsize, "mykey_codec_summary_size"))
+    for name, mirror_size, symbol in mirrors:
+        size = ctypes.c_size_t.in_dll(lib, symbol).value
+        if mirror_size != size:
+            raise OSError(f"{LIBRARY}: {name} is {mirror_size} bytes, C has {size}")
+
+    _lib = lib
+    return lib
+
+def available():
+    """True if the native library can be used"""
+    try:
+        load()
+        return True
+    except OSError:
+        return False
+
+def _ptr(array, ctype):
+    return array.ctypes.data_as(ctypes.POINTER(ctype))
+
+def as_images(images):
+    """View a buffer or array of 512-byte images as a contiguous (N, 128) uint32 array"""
+    if not isinstance(images, np.ndarray):
+        images = np.frombuffer(images, dtype=np.uint32)
+    images = np.ascontiguousarray(images, dtype=np.uint32)
+    if images.size % BLOCKS:
+        raise ValueError("buffer is not a whole number of 512-byte images")
+    return images.reshape(-1, BLOCKS)
+
+def _split(count, threads):
+    step = max(1, -(-count // threads))
+    return [(start, min(start + step, count)) for start in range(0, count, step)]
+
+def decode_blocks(blocks):
+    """encode_decode every uint32 in a copy of blocks"""
+    out = np.array(blocks, dtype=np.uint32, copy=True, order="C")
+    load().mykey_codec_decode_blocks(_ptr(out, ctypes.c_uint32), out.size)
+    return out
+
+def summarize(images, uids, keys=None, threads=1):
+    """
+    Decode N images into a SUMMARY_DTYPE array.
+    keys: stored encryption keys, or None to derive them from UID and image like the firmware.
+    threads > 1 splits the batch, each slice runs natively without the GIL.
+    """
+    lib = load()
+    images = as_images(images)
+    count = images.shape[0]
+    uids = np.ascontiguousarray(uids, dtype=np.uint64)
+    if uids.shape != (count,):
+        raise ValueError("need one UID per image")
+    if keys is not None:
+        keys = np.ascontiguousarray(keys, dtype=np.uint32)
+        if keys.shape != (count,):
+            raise ValueError("need one key per image")
+
+    out = np.zeros(count, dtype=SUMMARY_DTYPE)
+
+    def run(span):
+        start, end = span
+        lib.mykey_codec_summarize(
+            _ptr(images[start:end], ctypes.c_uint32),
+            _ptr(uids[start:end], ctypes.c_uint64),
+            _ptr(keys[start:end], ctypes.c_uint32) if keys is not None else None,
+            end - start,
+            out[start:end].ctypes.data)
+
+    if count == 0:
+        return out
+    if threads <= 1:
+        run((0, count))
+    else:
+        with ThreadPoolExecutor(threads) as executor:
+            list(executor.map(run, _split(count, threads)))
+    return out
+
+def encryption_key(uid, image):
+    """Firmware key derivation for a single image"""
+    image = as_images(image)
+    return load().mykey_codec_encryption_key(uid, _ptr(image, ctypes.c_uint32))
+
+def read_trace(data):
+    """Split a trace (bytes) into its header and a TRACE_RECORD_DTYPE array, raises ValueError"""
+    if len(data) < TRACE_HEADER_DTYPE.itemsize:
+        raise ValueError("trace too short")
+    header = np.frombuffer(data, dtype=TRACE_HEADER_DTYPE, count=1)[0]
+    if header["magic"] != TRACE_MAGIC or header["version"] != TRACE_VERSION:
+        raise ValueError("not a MyKey trace (bad magic or version)")
+    if header["record_size"] != TRACE_RECORD_DTYPE.itemsize:
+        raise ValueError(f"unexpected record size {header['record_size']}")
+    count = int(header["count"])
+    if TRACE_HEADER_DTYPE.itemsize + count * TRACE_RECORD_DTYPE.itemsize > len(data):
+        raise ValueError("trace truncated")
+    records = np.frombuffer(data, dtype=TRACE_RECORD_DTYPE, count=count,
+                            offset=TRACE_HEADER_DTYPE.itemsize)
+    return header, records
+
+def replay(data, mode=None, baseline=None, baseline_uid=0):
+    """
+    Feed a recorded trace (bytes) through the firmware read pipeline.
+    mode: a READ_MODES name, None for the recorded one. baseline: previous image of
+    baseline_uid for incremental replays. Returns a dict, raises ValueError on a bad trace.
+    """
+    lib = load()
+    header, _ = read_trace(data)
+    mode_id = int(header["mode"]) if mode is None else READ_MODES[mode]
+    if baseline is not None:
+        baseline = as_images(baseline)
+
+    pipeline = _Pipeline()
+    result = _Replay()
+    if not lib.mykey_trace_replay(
+            data, len(data), mode_id,
+            _ptr(baseline, ctypes.c_uint32) if baseline is not None else None,
+            baseline_uid, ctypes.byref(pipeline), ctypes.byref(result)):
+        raise ValueError("not a MyKey trace")
+
+    out = {name: getattr(result, name) for name, _ in _Replay._fields_}
+    out.update({
+        "mode": next(name for name, value in READ_MODES.items() if value == mode_id),
+        "blocks_read": pipeline.block_count,
+        "blocks_changed": pipeline.changed_count,
+        "stages": pipeline.stages,
+        "encryption_key": pipeline.encryption_key,
+        "credit": pipeline.credit,
+        "image": np.array(pipeline.eeprom, dtype=np.uint32),
+    })
+    return out
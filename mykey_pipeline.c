@@ -0,0 +1,279 @@
+#include "mykey_pipeline.h"
+#include <string.h>
+
+// Read first: key derivation, then credit, then the rest of the info view
+static const uint8_t mykey_pipeline_priority[] = {
+    0x06, 0x18, 0x19, // Key
+    0x21, // Credit
+    0x07, 0x12, 0x3C, // Serial, op counter, history pointer
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, // History ring
+};
+
+#define MYKEY_PIPELINE_PRIORITY_COUNT (sizeof(mykey_pipeline_priority))
+
+// Incremental reads: blocks every top-up or purchase rewrites
+static const uint8_t mykey_pipeline_markers[] = {
+    0x12, // Op counter
+    0x3C, // History pointer
+    0x21, // Credit
+};
+
+// Everything a transaction may touch besides the markers
+static const uint8_t mykey_pipeline_volatile[] = {
+    0x05, 0x06, // ST25TB counters
+    0x22, 0x23, 0x24, 0x25, 0x26, 0x27, // Credit copies and previous credit
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, // History ring
+};
+
+#define MYKEY_PIPELINE_MARKER_COUNT (sizeof(mykey_pipeline_markers))
+#define MYKEY_PIPELINE_VOLATILE_COUNT (sizeof(mykey_pipeline_volatile))
+
+// Fill order with the blocks to read for a mode, returns how many
+size_t mykey_pipeline_order(MyKeyReadMode mode, uint8_t* order) {
+    size_t count = 0;
+    uint32_t listed[MYKEY_CODEC_BLOCKS / 32] = {0};
+
+    for(size_t i = 0; i < MYKEY_PIPELINE_PRIORITY_COUNT; i++) {
+        uint8_t block_num = mykey_pipeline_priority[i];
+        order[count++] = block_num;
+        listed[block_num / 32] |= 1UL << (block_num % 32);
+    }
+
+    // Incremental reads fall back to a full read when the card is not the known one
+    if(mode != MyKeyReadModeQuick) {
+        for(size_t block_num = 0; block_num < MYKEY_CODEC_BLOCKS; block_num++) {
+            if(!(listed[block_num / 32] & (1UL << (block_num % 32)))) {
+                order[count++] = block_num;
+            }
+        }
+    }
+
+    return count;
+}
+
+void mykey_pipeline_init(MyKeyPipeline* pipeline, uint64_t uid) {
+    memset(pipeline, 0, sizeof(MyKeyPipeline));
+    pipeline->uid = uid;
+}
+
+// Start from a previous snapshot of the same UID, blocks that are not re-read
+// are taken from it once the read completes
+void mykey_pipeline_init_incremental(
+    MyKeyPipeline* pipeline,
+    uint64_t uid,
+    const uint32_t* baseline) {
+    mykey_pipeline_init(pipeline, uid);
+    pipeline->baseline = baseline;
+}
+
+bool mykey_pipeline_has_block(const MyKeyPipeline* pipeline, uint8_t block_num) {
+    return pipeline->present[block_num / 32] & (1UL << (block_num % 32));
+}
+
+static bool mykey_pipeline_has_info(const MyKeyPipeline* pipeline) {
+    for(size_t i = 0; i < MYKEY_PIPELINE_PRIORITY_COUNT; i++) {
+        if(!mykey_pipeline_has_block(pipeline, mykey_pipeline_priority[i])) return false;
+    }
+    return true;
+}
+
+// Run every decoder whose inputs just became complete, returns the stages newly reached
+static uint32_t mykey_pipeline_decode(MyKeyPipeline* pipeline) {
+    uint32_t reached = 0;
+
+    if(!(pipeline->stages & MYKEY_PIPELINE_KEY) && mykey_pipeline_has_block(pipeline, 0x06) &&
+       mykey_pipeline_has_block(pipeline, 0x18) && mykey_pipeline_has_block(pipeline, 0x19)) {
+        pipeline->encryption_key = mykey_codec_encryption_key(pipeline->uid, pipeline->eeprom);
+        reached |= MYKEY_PIPELINE_KEY;
+    }
+
+    if((pipeline->stages | reached) & MYKEY_PIPELINE_KEY &&
+       !(pipeline->stages & MYKEY_PIPELINE_CREDIT) && mykey_pipeline_has_block(pipeline, 0x21)) {
+        pipeline->credit = mykey_codec_credit(pipeline->eeprom, pipeline->encryption_key);
+        reached |= MYKEY_PIPELINE_CREDIT;
+    }
+
+    if(!(pipeline->stages & MYKEY_PIPELINE_INFO) && mykey_pipeline_has_info(pipeline)) {
+        reached |= MYKEY_PIPELINE_INFO;
+    }
+
+    pipeline->stages |= reached;
+    return reached;
+}
+
+// Store one block fetched from the card, returns the stages newly reached
+uint32_t mykey_pipeline_feed(MyKeyPipeline* pipeline, uint8_t block_num, uint32_t raw_block) {
+    if(block_num >= MYKEY_CODEC_BLOCKS) return 0;
+
+    // ST25TB blocks need byte-swapping to match libmikai's big-endian format
+    pipeline->eeprom[block_num] = __builtin_bswap32(raw_block);
+    if(!mykey_pipeline_has_block(pipeline, block_num)) {
+        pipeline->present[block_num / 32] |= 1UL << (block_num % 32);
+        pipeline->block_count++;
+        if(pipeline->baseline && pipeline->eeprom[block_num] != pipeline->baseline[block_num]) {
+            pipeline->changed_count++;
+        }
+    }
+
+    return mykey_pipeline_decode(pipeline);
+}
+
+// Read the missing blocks of order through the transport. Blocks already present
+// (from an earlier, interrupted attempt on the same card) are not read again.
+static bool mykey_pipeline_fetch(
+    MyKeyPipeline* pipeline,
+    const uint8_t* order,
+    size_t count,
+    MyKeyPipelineReadBlock read_block,
+    void* read_context,
+    MyKeyPipelineProgress progress,
+    void* progress_context) {
+    size_t since_progress = 0;
+
+    for(size_t i = 0; i < count; i++) {
+        uint8_t block_num = order[i];
+        if(mykey_pipeline_has_block(pipeline, block_num)) continue;
+
+        uint32_t block;
+        if(!read_block(read_context, block_num, &block)) {
+            return false;
+        }
+
+        uint32_t reached = mykey_pipeline_feed(pipeline, block_num, block);
+        if(progress && (reached || ++since_progress >= MYKEY_PIPELINE_PROGRESS_STEP)) {
+            since_progress = 0;
+            progress(progress_context, pipeline);
+        }
+    }
+
+    return true;
+}
+
+static void mykey_pipeline_complete(
+    MyKeyPipeline* pipeline,
+    MyKeyPipelineProgress progress,
+    void* progress_context) {
+    pipeline->stages |= MYKEY_PIPELINE_COMPLETE;
+    if(progress) progress(progress_context, pipeline);
+}
+
+bool mykey_pipeline_run(
+    MyKeyPipeline* pipeline,
+    const uint8_t* order,
+    size_t count,
+    MyKeyPipelineReadBlock read_block,
+    void* read_context,
+    MyKeyPipelineProgress progress,
+    void* progress_context) {
+    if(!mykey_pipeline_fetch(
+           pipeline, order, count, read_block, read_context, progress, progress_context)) {
+        return false;
+    }
+
+    mykey_pipeline_complete(pipeline, progress, progress_context);
+    return true;
+}
+
+typedef enum {
+    MyKeyPipelineUnchanged, // Markers as in the baseline
+    MyKeyPipelineTransaction, // Top-up or purchase since the baseline
+    MyKeyPipelineRewritten, // Op counter went backwards: reset or rewritten
+} MyKeyPipelineChange;
+
+// What happened to the card since the baseline, once the markers are in
+static MyKeyPipelineChange mykey_pipeline_change(const MyKeyPipeline* pipeline) {
+    const uint32_t* eeprom = pipeline->eeprom;
+    const uint32_t* baseline = pipeline->baseline;
+
+    bool markers_changed = false;
+    for(size_t i = 0; i < MYKEY_PIPELINE_MARKER_COUNT; i++) {
+        uint8_t block_num = mykey_pipeline_markers[i];
+        if(eeprom[block_num] != baseline[block_num]) markers_changed = true;
+    }
+    if(!markers_changed) return MyKeyPipelineUnchanged;
+
+    uint32_t op_count = eeprom[0x12] & 0x00FFFFFF;
+    uint32_t baseline_op_count = baseline[0x12] & 0x00FFFFFF;
+    return op_count < baseline_op_count ? MyKeyPipelineRewritten : MyKeyPipelineTransaction;
+}
+
+// Which blocks still have to come from the card once the markers are in
+static size_t mykey_pipeline_incremental_order(const MyKeyPipeline* pipeline, uint8_t* order) {
+    switch(mykey_pipeline_change(pipeline)) {
+        case MyKeyPipelineUnchanged:
+            return 0;
+        case MyKeyPipelineRewritten:
+            return mykey_pipeline_order(MyKeyReadModeFull, order);
+        default: // MyKeyPipelineTransaction
+            memcpy(order, mykey_pipeline_volatile, MYKEY_PIPELINE_VOLATILE_COUNT);
+            return MYKEY_PIPELINE_VOLATILE_COUNT;
+    }
+}
+
+// Blocks an incremental re-read fetches from the card, as far as is known yet. Until
+// the markers are in, a transaction is assumed.
+size_t mykey_pipeline_incremental_planned(const MyKeyPipeline* pipeline) {
+    if(!pipeline->baseline) return MYKEY_CODEC_BLOCKS;
+
+    for(size_t i = 0; i < MYKEY_PIPELINE_MARKER_COUNT; i++) {
+        if(!mykey_pipeline_has_block(pipeline, mykey_pipeline_markers[i])) {
+            return MYKEY_PIPELINE_MARKER_COUNT + MYKEY_PIPELINE_VOLATILE_COUNT;
+        }
+    }
+
+    switch(mykey_pipeline_change(pipeline)) {
+        case MyKeyPipelineUnchanged:
+            return MYKEY_PIPELINE_MARKER_COUNT;
+        case MyKeyPipelineRewritten:
+            return MYKEY_CODEC_BLOCKS; // The full order includes the markers
+        default: // MyKeyPipelineTransaction
+            return MYKEY_PIPELINE_MARKER_COUNT + MYKEY_PIPELINE_VOLATILE_COUNT;
+    }
+}
+
+// Re-read a card already known from pipeline->baseline. The change markers are read
+// first and decide how much else is fetched, everything else is merged from the
+// baseline into the new snapshot. Without a baseline this is a full read.
+bool mykey_pipeline_run_incremental(
+    MyKeyPipeline* pipeline,
+    MyKeyPipelineReadBlock read_block,
+    void* read_context,
+    MyKeyPipelineProgress progress,
+    void* progress_context) {
+    uint8_t order[MYKEY_CODEC_BLOCKS];
+
+    if(!pipeline->baseline) {
+        size_t count = mykey_pipeline_order(MyKeyReadModeFull, order);
+        return mykey_pipeline_run(
+            pipeline, order, count, read_block, read_context, progress, progress_context);
+    }
+
+    if(!mykey_pipeline_fetch(
+           pipeline,
+           mykey_pipeline_markers,
+           MYKEY_PIPELINE_MARKER_COUNT,
+           read_block,
+           read_context,
+           progress,
+           progress_context)) {
+        return false;
+    }
+
+    size_t count = mykey_pipeline_incremental_order(pipeline, order);
+    if(!mykey_pipeline_fetch(
+           pipeline, order, count, read_block, read_context, progress, progress_context)) {
+        return false;
+    }
+
+    // Merge: unread blocks keep their baseline value
+    for(size_t block_num = 0; block_num < MYKEY_CODEC_BLOCKS; block_num++) {
+        if(!mykey_pipeline_has_block(pipeline, block_num)) {
+            pipeline->eeprom[block_num] = pipeline->baseline[block_num];
+            pipeline->present[block_num / 32] |= 1UL << (block_num % 32);
+        }
+    }
+    mykey_pipeline_decode(pipeline);
+
+    mykey_pipeline_complete(pipeline, progress, progress_context);
+    return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+// Progressive read pipeline. No Furi dependencies: blocks come from a transport
+// callback (the ST25TB poller on the device) and feed the decoders as soon as
+// each one's inputs are in.
+
+#include "mykey_codec.h"
+
+// Pipeline stages, reported as a bitmask
+#define MYKEY_PIPELINE_KEY (1 << 0) // 0x06, 0x18, 0x19 in: encryption key derived
+#define MYKEY_PIPELINE_CREDIT (1 << 1) // 0x21 in: credit decoded
+#define MYKEY_PIPELINE_INFO (1 << 2) // Everything the info view shows is in
+#define MYKEY_PIPELINE_COMPLETE (1 << 3) // Every block of the read order is in
+
+// Blocks between two progress reports when no stage changes
+#define MYKEY_PIPELINE_PROGRESS_STEP 16
+
+typedef enum {
+    MyKeyReadModeFull, // All 128 blocks, decode-critical ones first
+    MyKeyReadModeQuick, // Only the blocks the info view needs
+    MyKeyReadModeIncremental, // Known UID: change markers, then only what may have changed
+} MyKeyReadMode;
+
+typedef struct {
+    uint64_t uid;
+    uint32_t eeprom[MYKEY_CODEC_BLOCKS]; // libmikai big-endian order
+    uint32_t present[MYKEY_CODEC_BLOCKS / 32];
+    uint16_t block_count; // Blocks fetched from the card
+    uint16_t changed_count; // Fetched blocks that differ from the baseline
+    const uint32_t* baseline; // Previous snapshot of this UID for incremental reads, or NULL
+    uint32_t encryption_key;
+    uint16_t credit;
+    uint32_t stages;
+} MyKeyPipeline;
+
+// Transport: fetch one block as the card returns it (little-endian), false on RF error
+typedef bool (*MyKeyPipelineReadBlock)(void* context, uint8_t block_num, uint32_t* block);
+// Progress: called with the stages reached so far
+typedef void (*MyKeyPipelineProgress)(void* context, const MyKeyPipeline* pipeline);
+
+size_t mykey_pipeline_order(MyKeyReadMode mode, uint8_t* order);
+void mykey_pipeline_init(MyKeyPipeline* pipeline, uint64_t uid);
+void mykey_pipeline_init_incremental(
+    MyKeyPipeline* pipeline,
+    uint64_t uid,
+    const uint32_t* baseline);
+bool mykey_pipeline_has_block(const MyKeyPipeline* pipeline, uint8_t block_num);
+size_t mykey_pipeline_incremental_planned(const MyKeyPipeline* pipeline);
+uint32_t mykey_pipeline_feed(MyKeyPipeline* pipeline, uint8_t block_num, uint32_t raw_block);
+bool mykey_pipeline_run(
+    MyKeyPipeline* pipeline,
+    const uint8_t* order,
+    size_t count,
+    MyKeyPipelineReadBlock read_block,
+    void* read_context,
+    MyKeyPipelineProgress progress,
+    void* progress_context);
+bool mykey_pipeline_run_incremental(
+    MyKeyPipeline* pipeline,
+    MyKeyPipelineReadBlock read_block,
+    void* read_context,
+    MyKeyPipelineProgress progress,
+    void* progress_context);
@@ -0,0 +1,230 @@
+#include "mykey_trace.h"
+#include <string.h>
+
+// The header and records are written as they are in memory
+_Static_assert(sizeof(MyKeyTraceHeader) == 16, "MyKeyTraceHeader layout");
+_Static_assert(sizeof(MyKeyTraceRecord) == 16, "MyKeyTraceRecord layout");
+_Static_assert(
+    offsetof(MyKeyTrace, records) == sizeof(MyKeyTraceHeader),
+    "MyKeyTrace records must follow the header");
+
+const size_t mykey_trace_pipeline_size = sizeof(MyKeyPipeline);
+const size_t mykey_trace_replay_size = sizeof(MyKeyTraceReplay);
+
+void mykey_trace_init(MyKeyTrace* trace, MyKeyReadMode mode) {
+    memset(&trace->header, 0, sizeof(MyKeyTraceHeader));
+    memcpy(trace->header.magic, MYKEY_TRACE_MAGIC, sizeof(trace->header.magic));
+    trace->header.version = MYKEY_TRACE_VERSION;
+    trace->header.mode = mode;
+    trace->header.record_size = sizeof(MyKeyTraceRecord);
+}
+
+void mykey_trace_add(
+    MyKeyTrace* trace,
+    MyKeyTraceOp op,
+    uint8_t arg,
+    uint8_t error,
+    uint64_t data,
+    uint32_t time_us) {
+    MyKeyTraceHeader* header = &trace->header;
+
+    // Waiting for a card polls continuously, keep one record per run of empty polls
+    if(op == MyKeyTraceOpAbsent && header->count > 0) {
+        MyKeyTraceRecord* last = &trace->records[header->count - 1];
+        if(last->op == MyKeyTraceOpAbsent) {
+            last->data++;
+            last->time_us = time_us;
+            return;
+        }
+    }
+
+    if(header->count >= MYKEY_TRACE_CAPACITY) {
+        header->flags |= MYKEY_TRACE_FLAG_TRUNCATED;
+        return;
+    }
+
+    MyKeyTraceRecord* record = &trace->records[header->count++];
+    record->op = op;
+    record->arg = arg;
+    record->error = error;
+    record->reserved = 0;
+    record->time_us = time_us;
+    record->data = op == MyKeyTraceOpAbsent ? 1 : data;
+}
+
+// Bytes to write: the header and the records in use
+size_t mykey_trace_size(const MyKeyTrace* trace) {
+    return sizeof(MyKeyTraceHeader) + trace->header.count * sizeof(MyKeyTraceRecord);
+}
+
+// Replay state: the card as the trace saw it and the recorded reads of every block
+typedef struct {
+    const MyKeyTraceRecord* records;
+    uint32_t count;
+    uint32_t image[MYKEY_CODEC_BLOCKS]; // As received from the poller
+    uint32_t known[MYKEY_CODEC_BLOCKS / 32];
+    uint8_t attempts[MYKEY_CODEC_BLOCKS]; // Reads of each block served so far
+    uint32_t read_ok_us;
+    uint32_t read_error_us;
+    MyKeyTraceReplay* result;
+} MyKeyTraceReplayer;
+
+// The n-th recorded read of a block, or NULL if the recording read it fewer times
+static const MyKeyTraceRecord* mykey_trace_nth_read(
+    const MyKeyTraceReplayer* replayer,
+    uint8_t block_num,
+    uint32_t n) {
+    for(uint32_t i = 0; i < replayer->count; i++) {
+        const MyKeyTraceRecord* record = &replayer->records[i];
+        if(record->op != MyKeyTraceOpRead || record->arg != block_num) continue;
+        if(n-- == 0) return record;
+    }
+    return NULL;
+}
+
+// Pipeline transport: the block as recorded. Failures are keyed by block and attempt,
+// so a replay in another order or mode fails the same blocks the recording did.
+static bool mykey_trace_replay_read_block(void* context, uint8_t block_num, uint32_t* block) {
+    MyKeyTraceReplayer* replayer = context;
+    MyKeyTraceReplay* result = replayer->result;
+    const MyKeyTraceRecord* recorded =
+        mykey_trace_nth_read(replayer, block_num, replayer->attempts[block_num]);
+    if(replayer->attempts[block_num] < UINT8_MAX) replayer->attempts[block_num]++;
+
+    result->reads++;
+    if(recorded && recorded->error) {
+        result->read_errors++;
+        result->estimated_us += replayer->read_error_us;
+        return false;
+    }
+    if(!(replayer->known[block_num / 32] & (1UL << (block_num % 32)))) {
+        result->missing++;
+        result->read_errors++;
+        result->estimated_us += replayer->read_error_us;
+        return false;
+    }
+
+    *block = replayer->image[block_num];
+    result->estimated_us += replayer->read_ok_us;
+    return true;
+}
+
+// Reconstruct the card and the mean read latencies from the recording
+static void mykey_trace_replay_scan(MyKeyTraceReplayer* replayer) {
+    MyKeyTraceReplay* result = replayer->result;
+    uint64_t ok_us = 0, error_us = 0;
+    uint32_t ok_count = 0, error_count = 0;
+    uint32_t first_detect_us = 0;
+    bool detected = false;
+
+    for(uint32_t i = 0; i < replayer->count; i++) {
+        const MyKeyTraceRecord* record = &replayer->records[i];
+        const MyKeyTraceRecord* previous = i > 0 ? &replayer->records[i - 1] : NULL;
+
+        switch(record->op) {
+            case MyKeyTraceOpDetect:
+                if(!detected) {
+                    first_detect_us = record->time_us;
+                    result->uid = record->data;
+                    detected = true;
+                }
+                break;
+            case MyKeyTraceOpRead: {
+                // A read's latency runs from the operation before it in the same session
+                uint32_t latency = previous ? record->time_us - previous->time_us : 0;
+                if(record->error) {
+                    error_us += latency;
+                    error_count++;
+                } else if(record->arg < MYKEY_CODEC_BLOCKS) {
+                    replayer->image[record->arg] = record->data;
+                    replayer->known[record->arg / 32] |= 1UL << (record->arg % 32);
+                    ok_us += latency;
+                    ok_count++;
+                }
+                break;
+            }
+            case MyKeyTraceOpDone:
+                result->recorded_done = true;
+                break;
+            case MyKeyTraceOpPower:
+                result->current_ma = (uint32_t)record->data;
+                result->voltage_mv = record->data >> 32;
+                break;
+            default:
+                break;
+        }
+
+        if(detected) {
+            result->recorded_us = record->time_us - first_detect_us;
+        }
+    }
+
+    replayer->read_ok_us = ok_count ? ok_us / ok_count : 0;
+    replayer->read_error_us = error_count ? error_us / error_count : replayer->read_ok_us;
+}
+
+// Feed a recorded trace back through the read pipeline, one pipeline run per
+// recorded card detection like the reader does. mode may differ from the recorded
+// one to compare strategies on the same exchange. baseline (with baseline_uid)
+// is the previous snapshot for MyKeyReadModeIncremental, or NULL.
+// Returns false if data is not a valid trace.
+bool mykey_trace_replay(
+    const void* data,
+    size_t size,
+    MyKeyReadMode mode,
+    const uint32_t* baseline,
+    uint64_t baseline_uid,
+    MyKeyPipeline* pipeline,
+    MyKeyTraceReplay* result) {
+    const MyKeyTraceHeader* header = data;
+    if(size < sizeof(MyKeyTraceHeader) ||
+       memcmp(header->magic, MYKEY_TRACE_MAGIC, sizeof(header->magic)) != 0 ||
+       header->version != MYKEY_TRACE_VERSION ||
+       header->record_size != sizeof(MyKeyTraceRecord) ||
+       header->count > (size - sizeof(MyKeyTraceHeader)) / sizeof(MyKeyTraceRecord)) {
+        return false;
+    }
+
+    memset(result, 0, sizeof(MyKeyTraceReplay));
+    MyKeyTraceReplayer replayer = {
+        .records = (const MyKeyTraceRecord*)(header + 1),
+        .count = header->count,
+        .result = result,
+    };
+    mykey_trace_replay_scan(&replayer);
+
+    uint8_t order[MYKEY_CODEC_BLOCKS];
+    size_t order_count = mykey_pipeline_order(mode, order);
+    mykey_pipeline_init(pipeline, 0);
+
+    for(uint32_t i = 0; i < replayer.count && !result->done; i++) {
+        const MyKeyTraceRecord* record = &replayer.records[i];
+        if(record->op != MyKeyTraceOpDetect) continue;
+
+        uint64_t uid = record->data;
+        result->sessions++;
+        if(pipeline->uid != uid || pipeline->block_count == 0) {
+            if(mode == MyKeyReadModeIncremental && baseline && baseline_uid == uid) {
+                mykey_pipeline_init_incremental(pipeline, uid, baseline);
+            } else {
+                mykey_pipeline_init(pipeline, uid);
+            }
+        }
+
+        if(mode == MyKeyReadModeIncremental) {
+            result->done = mykey_pipeline_run_incremental(
+                pipeline, mykey_trace_replay_read_block, &replayer, NULL, NULL);
+        } else {
+            result->done = mykey_pipeline_run(
+                pipeline,
+                order,
+                order_count,
+                mykey_trace_replay_read_block,
+                &replayer,
+                NULL,
+                NULL);
+        }
+    }
+
+    return true;
+}
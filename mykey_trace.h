@@ -0,0 +1,89 @@
+#pragma once
+
+// NFC exchange traces. No Furi dependencies: the app records every poller
+// operation of a read, the host replays a trace through the same read pipeline.
+//
+// File layout (little-endian): MyKeyTraceHeader, then header.count records.
+
+#include "mykey_pipeline.h"
+
+#define MYKEY_TRACE_MAGIC "MKTR"
+#define MYKEY_TRACE_VERSION 1
+#define MYKEY_TRACE_EXTENSION ".mktr"
+
+// Records kept per read, a full read with a few retries is ~140
+#define MYKEY_TRACE_CAPACITY 256
+
+// Header flags
+#define MYKEY_TRACE_FLAG_TRUNCATED (1 << 0) // Ran out of records, the tail is missing
+#define MYKEY_TRACE_FLAG_BASELINE (1 << 1) // Incremental read against a snapshot of the card
+
+typedef enum {
+    MyKeyTraceOpDetect, // Card selected: arg = St25tbType, data = UID
+    MyKeyTraceOpRead, // Block read: arg = block, error = St25tbError, data = block as received
+    MyKeyTraceOpAbsent, // Poll without a card: data = consecutive empty polls
+    MyKeyTraceOpDone, // Read completed: data = MYKEY_PIPELINE_* stages
+    MyKeyTraceOpPower, // Battery sampled with the field up: data = mV << 32 | mA drawn
+} MyKeyTraceOp;
+
+typedef struct {
+    char magic[4];
+    uint8_t version;
+    uint8_t mode; // MyKeyReadMode
+    uint8_t record_size;
+    uint8_t flags;
+    uint32_t count;
+    uint32_t reserved;
+} MyKeyTraceHeader;
+
+typedef struct {
+    uint8_t op; // MyKeyTraceOp
+    uint8_t arg;
+    uint8_t error;
+    uint8_t reserved;
+    uint32_t time_us; // Since the reader started, taken when the operation returned
+    uint64_t data;
+} MyKeyTraceRecord;
+
+typedef struct {
+    MyKeyTraceHeader header;
+    MyKeyTraceRecord records[MYKEY_TRACE_CAPACITY];
+} MyKeyTrace;
+
+// Outcome of a replay, compared against the recording by the host driver
+typedef struct {
+    uint64_t uid;
+    bool recorded_done; // The recorded read completed
+    bool done; // The replayed read completed
+    uint32_t sessions; // Card detections replayed
+    uint32_t reads; // Block reads the pipeline asked for
+    uint32_t read_errors; // Reads that failed, as recorded or for blocks missing from the trace
+    uint32_t missing; // Reads of blocks the trace has no data for
+    uint32_t recorded_us; // Field time of the recording, first detection to last operation
+    uint32_t estimated_us; // The replayed reads timed with the recorded latencies
+    uint32_t current_ma; // Recorded battery drain with the field up, 0 if not sampled
+    uint32_t voltage_mv;
+} MyKeyTraceReplay;
+
+void mykey_trace_init(MyKeyTrace* trace, MyKeyReadMode mode);
+void mykey_trace_add(
+    MyKeyTrace* trace,
+    MyKeyTraceOp op,
+    uint8_t arg,
+    uint8_t error,
+    uint64_t data,
+    uint32_t time_us);
+size_t mykey_trace_size(const MyKeyTrace* trace);
+
+// sizeof() of the structs the host bindings mirror, checked by mykey_native.py
+extern const size_t mykey_trace_pipeline_size;
+extern const size_t mykey_trace_replay_size;
+
+bool mykey_trace_replay(
+    const void* data,
+    size_t size,
+    MyKeyReadMode mode,
+    const uint32_t* baseline,
+    uint64_t baseline_uid,
+    MyKeyPipeline* pipeline,
+    MyKeyTraceReplay* result);
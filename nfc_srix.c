@@ -1,95 +1,455 @@
 #include "cogs_mikai.h"
+#include "mykey_pipeline.h"
+#include "mykey_trace.h"
 #include <furi.h>
+#include <furi_hal_cortex.h>
+#include <furi_hal_power.h>
+#include <string.h>
 #include <machine/endian.h>
 #include <nfc/nfc.h>
+#include <nfc/nfc_poller.h>
 #include <nfc/protocols/st25tb/st25tb.h>
+#include <nfc/protocols/st25tb/st25tb_poller.h>
 #include <nfc/protocols/st25tb/st25tb_poller_sync.h>
 
-bool mykey_read_from_nfc(COGSMyKaiApp* app) {
-    FURI_LOG_I(TAG, "Reading SRIX4K from NFC...");
+// Consecutive empty polls before a continuous reader forgets the last card
+#define MYKEY_SCAN_ABSENT_POLLS 3
+
+struct MyKeyReader {
+    Nfc* nfc;
+    NfcPoller* poller;
+    FuriMutex* mutex;
+    MyKeyPipeline* pipeline; // Owned by the NFC worker thread while running
+    MyKeyData* card; // Published snapshot of the pipeline, guarded by mutex
+    uint32_t card_stages;
+    MyKeyReaderStatus card_status;
+    uint32_t baseline[SRIX4K_BLOCKS]; // Previous snapshot for incremental reads
+    uint64_t baseline_uid;
+    bool baseline_valid;
+    St25tbPoller* st25tb_poller; // Protocol instance, valid during a poller callback
+    const St25tbData* poller_data; // Blocks of the poller's own full read, if it ran
+    MyKeyTrace* trace; // Exchange recorder, NULL when not capturing
+    uint64_t time_cycles;
+    uint32_t time_last_cycles;
+    MyKeyEnergyStat* energy; // Per MyKeyEnergyMode, NULL when not measuring
+    MyKeyEnergyMode energy_mode; // Path the last read took, the session is accounted under it
+    uint32_t session_start_tick;
+    uint32_t session_start_mah;
+    // Single reads: tick and gauge when the worker stopped the field, if session_ended
+    uint32_t session_end_tick;
+    uint32_t session_end_mah;
+    bool session_ended;
+    uint32_t read_start_us;
+    uint32_t idle_ma; // Drain before the field came up, sampled before the worker starts
+    // Written on the NFC worker thread only, read once the poller has stopped
+    bool power_sampled;
+    uint32_t current_ma; // Last sample with the field up, above idle
+    uint32_t voltage_mv;
+    uint64_t current_sum_ma; // Every sample of the session, for its average
+    uint64_t voltage_sum_mv;
+    uint32_t power_samples;
+    uint8_t order[SRIX4K_BLOCKS];
+    size_t order_count;
+    MyKeyReadMode mode;
+    bool continuous;
+    uint64_t last_uid;
+    bool last_uid_valid;
+    uint8_t absent_polls;
+    MyKeyReaderCallback callback;
+    void* context;
+};
+
+// Check if it's SRIX4K (ST25TBX512 or ST25TB04K or ST25TBX4K)
+static bool mykey_is_srix4k(St25tbType type) {
+    return type == St25tbTypeX512 || type == St25tbType04k || type == St25tbTypeX4k;
+}
 
-    bool success = false;
-    Nfc* nfc = nfc_alloc();
+// ST25TB UID bytes are in order [0..7], we need to assemble them big-endian
+// to match libmikai: uid[0] is MSB (bits 56-63), uid[7] is LSB (bits 0-7)
+static uint64_t mykey_uid_from_bytes(const uint8_t* uid_bytes) {
+    uint64_t uid = 0;
+    for(size_t i = 0; i < ST25TB_UID_SIZE && i < 8; i++) {
+        uid |= ((uint64_t)uid_bytes[i]) << ((7 - i) * 8);
+    }
+    return uid;
+}
 
-    // Detect ST25TB card type
-    St25tbType type;
-    St25tbError error = st25tb_poller_sync_detect_type(nfc, &type);
+// Microseconds since the reader started, from the DWT cycle counter. The counter
+// wraps every ~67 s, every poller event accumulates it so none is missed.
+static uint32_t mykey_reader_time_us(MyKeyReader* reader) {
+    uint32_t cycles = furi_hal_cortex_timer_get(0).start;
+    reader->time_cycles += cycles - reader->time_last_cycles;
+    reader->time_last_cycles = cycles;
+    return reader->time_cycles / furi_hal_cortex_instructions_per_microsecond();
+}
 
+// Battery drain right now, of the whole system. Discharge reads negative, on USB
+// power there is none.
+static uint32_t mykey_reader_battery_ma(void) {
+    float current = furi_hal_power_get_battery_current(FuriHalPowerICFuelGauge);
+    return current < 0 ? (uint32_t)(-current * 1000) : 0;
+}
+
+// Drain with the field up, minus the idle draw of the MCU, display and backlight
+static void mykey_reader_sample_power(MyKeyReader* reader) {
+    uint32_t current_ma = mykey_reader_battery_ma();
+    reader->current_ma = current_ma > reader->idle_ma ? current_ma - reader->idle_ma : 0;
+    reader->voltage_mv = furi_hal_power_get_battery_voltage(FuriHalPowerICFuelGauge) * 1000;
+    reader->current_sum_ma += reader->current_ma;
+    reader->voltage_sum_mv += reader->voltage_mv;
+    reader->power_samples++;
+}
+
+static void mykey_reader_trace(
+    MyKeyReader* reader,
+    MyKeyTraceOp op,
+    uint8_t arg,
+    uint8_t error,
+    uint64_t data) {
+    if(!reader->trace) return;
+    mykey_trace_add(reader->trace, op, arg, error, data, mykey_reader_time_us(reader));
+}
+
+// Pipeline transport over the running poller
+static bool mykey_reader_read_block(void* context, uint8_t block_num, uint32_t* block) {
+    MyKeyReader* reader = context;
+    St25tbError error = St25tbErrorNone;
+    if(reader->poller_data) {
+        *block = reader->poller_data->blocks[block_num];
+    } else {
+        error = st25tb_poller_read_block(reader->st25tb_poller, block, block_num);
+    }
+    mykey_reader_trace(
+        reader, MyKeyTraceOpRead, block_num, error, error == St25tbErrorNone ? *block : 0);
     if(error != St25tbErrorNone) {
-        FURI_LOG_E(TAG, "Failed to detect ST25TB card: %d", error);
-        nfc_free(nfc);
+        FURI_LOG_W(TAG, "Block 0x%02X read failed: %d", block_num, error);
         return false;
     }
+    return true;
+}
 
-    // Check if it's SRIX4K (ST25TBX512 or ST25TB04K or ST25TBX4K)
-    if(type != St25tbTypeX512 && type != St25tbType04k && type != St25tbTypeX4k) {
-        FURI_LOG_E(TAG, "Card is not SRIX4K compatible, type: %d", type);
-        nfc_free(nfc);
+// Copy the pipeline state out for the GUI thread, runs on the NFC worker thread
+static void mykey_reader_progress(void* context, const MyKeyPipeline* pipeline) {
+    MyKeyReader* reader = context;
+
+    furi_mutex_acquire(reader->mutex, FuriWaitForever);
+    MyKeyData* card = reader->card;
+    card->uid = pipeline->uid;
+    memcpy(card->eeprom, pipeline->eeprom, sizeof(card->eeprom));
+    card->encryption_key = pipeline->encryption_key;
+    card->current_credit = pipeline->credit;
+    card->is_reset = (pipeline->stages & MYKEY_PIPELINE_KEY) && mykey_is_reset(card);
+    card->is_loaded = pipeline->stages & MYKEY_PIPELINE_COMPLETE;
+    card->is_modified = false;
+    reader->card_stages = pipeline->stages;
+    reader->card_status.blocks_read = pipeline->block_count;
+    reader->card_status.blocks_changed = pipeline->changed_count;
+    reader->card_status.blocks_planned = reader->mode == MyKeyReadModeIncremental ?
+                                             mykey_pipeline_incremental_planned(pipeline) :
+                                             reader->order_count;
+    reader->card_status.incremental = pipeline->baseline != NULL;
+    furi_mutex_release(reader->mutex);
+
+    if(reader->callback) reader->callback(MyKeyReaderEventProgress, reader->context);
+}
+
+// Run the read pipeline on the card in the field. Returns true when the read is done.
+static bool mykey_reader_read_card(MyKeyReader* reader, const St25tbData* data, uint32_t now_us) {
+    uint64_t uid = mykey_uid_from_bytes(data->uid);
+    MyKeyPipeline* pipeline = reader->pipeline;
+    reader->absent_polls = 0;
+    mykey_reader_trace(reader, MyKeyTraceOpDetect, data->type, 0, uid);
+
+    // X512 passes the write check but has 16 blocks, the pipeline reads up to 0x7F
+    if(!mykey_is_srix4k(data->type) || st25tb_get_block_count(data->type) < SRIX4K_BLOCKS) {
+        FURI_LOG_E(TAG, "Card is not SRIX4K compatible, type: %d", data->type);
+        if(reader->callback) reader->callback(MyKeyReaderEventFailed, reader->context);
+        return false;
+    }
+    if(reader->last_uid_valid && reader->last_uid == uid) {
+        // Debounce: a card left on the reader is decoded once
         return false;
     }
 
-    FURI_LOG_I(TAG, "Detected ST25TB card type: %d", type);
-
-    // Allocate ST25TB data structure
-    St25tbData* st25tb_data = st25tb_alloc();
+    // Resume an interrupted read of the same card, start over for a new one
+    if(pipeline->uid != uid || pipeline->block_count == 0 ||
+       (pipeline->stages & MYKEY_PIPELINE_COMPLETE)) {
+        // Incremental reads only apply to the card the baseline came from
+        if(reader->mode == MyKeyReadModeIncremental && reader->baseline_valid &&
+           reader->baseline_uid == uid) {
+            mykey_pipeline_init_incremental(pipeline, uid, reader->baseline);
+            // Replaying this read needs the same snapshot
+            if(reader->trace) reader->trace->header.flags |= MYKEY_TRACE_FLAG_BASELINE;
+        } else {
+            mykey_pipeline_init(pipeline, uid);
+        }
+        reader->read_start_us = now_us;
+        FURI_LOG_I(TAG, "Card UID (big-endian): %016llX", uid);
+    }
 
-    // Read entire card
-    error = st25tb_poller_sync_read(nfc, st25tb_data);
+    bool done;
+    if(reader->mode == MyKeyReadModeIncremental) {
+        done = mykey_pipeline_run_incremental(
+            pipeline, mykey_reader_read_block, reader, mykey_reader_progress, reader);
+    } else {
+        done = mykey_pipeline_run(
+            pipeline,
+            reader->order,
+            reader->order_count,
+            mykey_reader_read_block,
+            reader,
+            mykey_reader_progress,
+            reader);
+    }
 
-    if(error != St25tbErrorNone) {
-        FURI_LOG_E(TAG, "Failed to read ST25TB card: %d", error);
-        st25tb_free(st25tb_data);
-        nfc_free(nfc);
+    if(!done) {
+        // Card lost mid-read, the next session resumes where this one stopped
+        if(reader->callback) reader->callback(MyKeyReaderEventFailed, reader->context);
         return false;
     }
 
-    // Extract UID (8 bytes for ST25TB)
-    // ST25TB UID bytes are in order [0..7], we need to assemble them big-endian
-    // to match libmikai: uid[0] is MSB (bits 56-63), uid[7] is LSB (bits 0-7)
-    app->mykey.uid = 0;
-    for(size_t i = 0; i < ST25TB_UID_SIZE && i < 8; i++) {
-        app->mykey.uid |= ((uint64_t)st25tb_data->uid[i]) << ((7 - i) * 8);
+    // A re-read without a usable baseline, or of a card whose counter went back,
+    // fetched every block: it cost a full read
+    MyKeyReadMode ran = pipeline->block_count == SRIX4K_BLOCKS ? MyKeyReadModeFull :
+                                                                 reader->mode;
+    reader->energy_mode = cogs_mikai_energy_mode(ran, reader->continuous);
+
+    FURI_LOG_I(
+        TAG,
+        "Card read (%u blocks, %u changed). Credit: %d cents",
+        pipeline->block_count,
+        pipeline->changed_count,
+        pipeline->credit);
+    reader->last_uid = uid;
+    reader->last_uid_valid = true;
+    mykey_reader_trace(reader, MyKeyTraceOpDone, 0, 0, pipeline->stages);
+    if(reader->energy || reader->trace) {
+        uint32_t read_us = mykey_reader_time_us(reader) - reader->read_start_us;
+        // Field is still up: this is what a read costs
+        mykey_reader_sample_power(reader);
+        mykey_reader_trace(
+            reader,
+            MyKeyTraceOpPower,
+            0,
+            0,
+            ((uint64_t)reader->voltage_mv << 32) | reader->current_ma);
+        if(reader->energy) {
+            MyKeyEnergyStat* stat = &reader->energy[reader->energy_mode];
+            stat->reads++;
+            stat->read_us += read_us;
+            // mA * us / 3600 = nAh
+            stat->read_charge_nah += (uint64_t)reader->current_ma * read_us / 3600;
+        }
     }
+    if(reader->callback) reader->callback(MyKeyReaderEventDone, reader->context);
+    return true;
+}
 
-    FURI_LOG_I(TAG, "Card UID (big-endian): %016llX", app->mykey.uid);
-    FURI_LOG_I(TAG, "UID bytes: %02X %02X %02X %02X %02X %02X %02X %02X",
-        st25tb_data->uid[0], st25tb_data->uid[1], st25tb_data->uid[2], st25tb_data->uid[3],
-        st25tb_data->uid[4], st25tb_data->uid[5], st25tb_data->uid[6], st25tb_data->uid[7]);
+static NfcCommand mykey_reader_poller_callback(NfcGenericEvent event, void* context) {
+    furi_assert(event.protocol == NfcProtocolSt25tb);
+    MyKeyReader* reader = context;
+    const St25tbPollerEvent* st25tb_event = event.event_data;
+    NfcCommand command = NfcCommandReset;
+    uint32_t now_us = mykey_reader_time_us(reader);
+    bool done = false;
+
+    // The field is up from the first poll on, sessions that never complete a read get
+    // this sample. The GUI thread never samples, it would race the worker.
+    if(reader->energy && !reader->power_sampled) {
+        mykey_reader_sample_power(reader);
+        reader->power_sampled = true;
+    }
 
-    // Copy blocks to MyKey data structure
-    // ST25TB stores data in blocks, we need to read all 128 blocks (512 bytes total)
-    size_t num_blocks = st25tb_get_block_count(type);
-    if(num_blocks > SRIX4K_BLOCKS) {
-        num_blocks = SRIX4K_BLOCKS;
+    if(st25tb_event->type == St25tbPollerEventTypeRequestMode) {
+        // Card selected, UID and type are known, nothing read yet. The pipeline reads
+        // over the poller, then the reset below should skip its own full read.
+        reader->st25tb_poller = event.instance;
+        done = mykey_reader_read_card(reader, nfc_poller_get_data(reader->poller), now_us);
+        reader->st25tb_poller = NULL;
+    } else if(st25tb_event->type == St25tbPollerEventTypeSuccess) {
+        // The poller keeps the requested mode across a reset, so its full read may
+        // still have run. Its blocks then stand in for the card: same decode, same
+        // events, and no second read.
+        reader->poller_data = nfc_poller_get_data(reader->poller);
+        done = mykey_reader_read_card(reader, reader->poller_data, now_us);
+        reader->poller_data = NULL;
+    } else if(st25tb_event->type == St25tbPollerEventTypeFailure) {
+        // No card in the field, forget it once it has been gone for a few polls
+        mykey_reader_trace(reader, MyKeyTraceOpAbsent, 0, st25tb_event->data->error, 0);
+        if(reader->absent_polls < MYKEY_SCAN_ABSENT_POLLS) {
+            reader->absent_polls++;
+        } else {
+            reader->last_uid_valid = false;
+        }
     }
 
-    // ST25TB blocks need byte-swapping to match libmikai's big-endian format
-    // Flipper SDK stores blocks in little-endian, libmikai expects big-endian
-    for(size_t i = 0; i < num_blocks; i++) {
-        app->mykey.eeprom[i] = __bswap32(st25tb_data->blocks[i]);
+    if(done && !reader->continuous) {
+        // The field goes down now, not when the scene stops the reader
+        reader->session_end_tick = furi_get_tick();
+        if(reader->energy) {
+            reader->session_end_mah = furi_hal_power_get_battery_remaining_capacity();
+        }
+        reader->session_ended = true;
+        command = NfcCommandStop;
     }
 
-    FURI_LOG_I(TAG, "Blocks byte-swapped to big-endian format");
+    // Restart detection instead of going on to the poller's own full read
+    return command;
+}
 
-    // Calculate encryption key from UID
-    mykey_calculate_encryption_key(&app->mykey);
+MyKeyReader* mykey_reader_alloc(void) {
+    MyKeyReader* reader = malloc(sizeof(MyKeyReader));
+    memset(reader, 0, sizeof(MyKeyReader));
+    reader->nfc = nfc_alloc();
+    reader->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    reader->pipeline = malloc(sizeof(MyKeyPipeline));
+    reader->card = malloc(sizeof(MyKeyData));
+    return reader;
+}
 
-    // Update cached values
-    app->mykey.is_loaded = true;
-    app->mykey.is_modified = false;  // Fresh read from card
-    app->mykey.is_reset = mykey_is_reset(&app->mykey);
-    app->mykey.current_credit = mykey_get_current_credit(&app->mykey);
+void mykey_reader_free(MyKeyReader* reader) {
+    furi_assert(reader);
+    mykey_reader_stop(reader);
+    free(reader->card);
+    free(reader->pipeline);
+    furi_mutex_free(reader->mutex);
+    nfc_free(reader->nfc);
+    free(reader);
+}
 
-    FURI_LOG_I(TAG, "Card loaded successfully. Credit: %d cents, Reset: %s",
-               app->mykey.current_credit,
-               app->mykey.is_reset ? "Yes" : "No");
+// Start polling. Continuous readers keep the field up and decode every new card
+// presented until stopped, single reads stop after the first complete card.
+void mykey_reader_start(
+    MyKeyReader* reader,
+    MyKeyReadMode mode,
+    bool continuous,
+    MyKeyReaderCallback callback,
+    void* context) {
+    furi_assert(reader);
+    furi_assert(!reader->poller);
+
+    reader->mode = mode;
+    reader->continuous = continuous;
+    reader->order_count = mykey_pipeline_order(mode, reader->order);
+    reader->callback = callback;
+    reader->context = context;
+    reader->last_uid_valid = false;
+    reader->absent_polls = 0;
+    reader->card_stages = 0;
+    memset(&reader->card_status, 0, sizeof(MyKeyReaderStatus));
+    memset(reader->card, 0, sizeof(MyKeyData));
+    mykey_pipeline_init(reader->pipeline, 0);
+
+    reader->time_cycles = 0;
+    reader->time_last_cycles = furi_hal_cortex_timer_get(0).start;
+    if(reader->trace) {
+        mykey_trace_init(reader->trace, mode);
+    }
+    reader->session_ended = false;
+    reader->power_sampled = false;
+    if(reader->energy) {
+        reader->energy_mode = cogs_mikai_energy_mode(mode, continuous);
+        // The worker is not running yet, nothing races this sample
+        reader->idle_ma = mykey_reader_battery_ma();
+        reader->current_ma = 0;
+        reader->voltage_mv = 0;
+        reader->current_sum_ma = 0;
+        reader->voltage_sum_mv = 0;
+        reader->power_samples = 0;
+        reader->session_start_mah = furi_hal_power_get_battery_remaining_capacity();
+        reader->session_start_tick = furi_get_tick();
+    }
 
-    success = true;
+    reader->poller = nfc_poller_alloc(reader->nfc, NfcProtocolSt25tb);
+    nfc_poller_start(reader->poller, mykey_reader_poller_callback, reader);
+}
 
-    st25tb_free(st25tb_data);
-    nfc_free(nfc);
+// Snapshot to diff against in MyKeyReadModeIncremental, set before starting.
+// A card with another UID is read in full.
+void mykey_reader_set_baseline(MyKeyReader* reader, const MyKeyData* key) {
+    furi_assert(reader);
+    furi_assert(!reader->poller);
 
-    return success;
+    memcpy(reader->baseline, key->eeprom, sizeof(reader->baseline));
+    reader->baseline_uid = key->uid;
+    reader->baseline_valid = true;
+}
+
+// Record every poller operation into trace from the next start on, NULL to stop.
+// The trace is caller-owned and only safe to read once the reader is stopped.
+void mykey_reader_set_trace(MyKeyReader* reader, MyKeyTrace* trace) {
+    furi_assert(reader);
+    furi_assert(!reader->poller);
+    reader->trace = trace;
+}
+
+// Account field-on time and battery drain for every session from the next start on,
+// NULL to stop. stats holds one MyKeyEnergyStat per MyKeyEnergyMode, each session goes
+// to the mode its reads actually ran as. Caller-owned, accumulates across sessions.
+void mykey_reader_set_energy(MyKeyReader* reader, MyKeyEnergyStat* stats) {
+    furi_assert(reader);
+    furi_assert(!reader->poller);
+    reader->energy = stats;
+}
+
+static void mykey_reader_energy_account(MyKeyReader* reader) {
+    MyKeyEnergyStat* stat = &reader->energy[reader->energy_mode];
+    uint32_t end_tick = reader->session_ended ? reader->session_end_tick : furi_get_tick();
+    uint32_t field_on_ms = (uint64_t)(end_tick - reader->session_start_tick) * 1000 /
+                           furi_kernel_get_tick_frequency();
+    uint32_t remaining_mah = reader->session_ended ?
+                                 reader->session_end_mah :
+                                 furi_hal_power_get_battery_remaining_capacity();
+
+    // Scan samples at every read, the field-on time is spread over all of them
+    uint32_t current_ma = 0;
+    uint32_t voltage_mv = 0;
+    if(reader->power_samples > 0) {
+        current_ma = reader->current_sum_ma / reader->power_samples;
+        voltage_mv = reader->voltage_sum_mv / reader->power_samples;
+    }
+
+    stat->sessions++;
+    stat->idle_ma = reader->idle_ma;
+    stat->field_on_ms += field_on_ms;
+    // mA * ms / 3600 = uAh
+    stat->charge_uah += (uint64_t)current_ma * field_on_ms / 3600;
+    stat->energy_uwh += (uint64_t)current_ma * voltage_mv * field_on_ms / 3600000;
+    if(remaining_mah < reader->session_start_mah) {
+        stat->gauge_mah += reader->session_start_mah - remaining_mah;
+    }
+
+    FURI_LOG_D(
+        TAG,
+        "Field on %lu ms at %lu mA above %lu mA idle, %lu mV",
+        field_on_ms,
+        current_ma,
+        reader->idle_ma,
+        voltage_mv);
+}
+
+void mykey_reader_stop(MyKeyReader* reader) {
+    furi_assert(reader);
+    if(!reader->poller) return;
+
+    nfc_poller_stop(reader->poller);
+    nfc_poller_free(reader->poller);
+    reader->poller = NULL;
+
+    if(reader->energy) {
+        mykey_reader_energy_account(reader);
+    }
+}
+
+// Copy out what has been decoded so far, returns the MYKEY_PIPELINE_* stages reached.
+// card->is_loaded is only set once the read is complete.
+uint32_t mykey_reader_get_card(MyKeyReader* reader, MyKeyData* card, MyKeyReaderStatus* status) {
+    furi_mutex_acquire(reader->mutex, FuriWaitForever);
+    memcpy(card, reader->card, sizeof(MyKeyData));
+    uint32_t stages = reader->card_stages;
+    if(status) *status = reader->card_status;
+    furi_mutex_release(reader->mutex);
+    return stages;
 }
 
 bool mykey_write_to_nfc(COGSMyKaiApp* app) {
@@ -113,8 +473,7 @@ bool mykey_write_to_nfc(COGSMyKaiApp* app) {
         return false;
     }
 
-    // Check if it's SRIX4K
-    if(type != St25tbTypeX512 && type != St25tbType04k && type != St25tbTypeX4k) {
+    if(!mykey_is_srix4k(type)) {
         FURI_LOG_E(TAG, "Card is not SRIX4K compatible, type: %d", type);
         nfc_free(nfc);
         return false;
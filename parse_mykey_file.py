@@ -1,12 +1,37 @@
 #!/usr/bin/env python3
 """
 COGES MyKey File Parser
-Parses .myk files created by the COGES MyKai Flipper Zero application.
+Parses dumps created by the COGES MyKai Flipper Zero application: .myk saves,
+raw data dumps and mykey_debug_*.txt captures (format sniffed from the first line).
  - a luhf shitscript
+
+Single file:  python3 parse_mykey_file.py <file.myk>
+Bulk mode:    python3 parse_mykey_file.py --bulk [-o out.csv|out.parquet] [-j N] <dir|glob|file|archive.mykpack>...
+Trace replay: python3 parse_mykey_file.py --replay [--mode M|--compare] [--baseline dump] [--repeat N] <file.mktr>...
 """
 
+import argparse
+import csv
+import glob
+import os
 import sys
+import time
 from datetime import datetime
+from multiprocessing import Pool
+
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
+try:
+    import mykey_native
+except ImportError:
+    mykey_native = None
+
+BULK_CHUNK_SIZE = 256
+BULK_COLUMNS = ["file", "uid", "encryption_key", "serial", "credit", "history_credit",
+                "op_count", "is_reset", "transactions"]
 
 def bswap32(val):
     """Byte swap 32-bit value"""
@@ -22,46 +47,455 @@ def encode_decode_block(block):
               (block & 0x000C0000) >> 6 | (block & 0x00030000) >> 12 | (block & 0x00000300) >> 6)
     return block & 0xFFFFFFFF
 
-def parse_mykey_file(filename):
-    """Parse a .myk file and display its contents"""
+def encode_decode_array(blocks):
+    """encode_decode_block over a numpy uint32 array (any shape)"""
+    block = blocks.astype(np.uint32, copy=True)
+    u = np.uint32
+    block ^= ((block & u(0x00C00000)) << 6 | (block & u(0x0000C000)) << 12 | (block & u(0x000000C0)) << 18 |
+              (block & u(0x000C0000)) >> 6 | (block & u(0x00030000)) >> 12 | (block & u(0x00000300)) >> 6)
+    block ^= ((block & u(0x30000000)) >> 6 | (block & u(0x0C000000)) >> 12 | (block & u(0x03000000)) >> 18 |
+              (block & u(0x00003000)) << 6 | (block & u(0x00000030)) << 12 | (block & u(0x0000000C)) << 6)
+    block ^= ((block & u(0x00C00000)) << 6 | (block & u(0x0000C000)) << 12 | (block & u(0x000000C0)) << 18 |
+              (block & u(0x000C0000)) >> 6 | (block & u(0x00030000)) >> 12 | (block & u(0x00000300)) >> 6)
+    return block
+
+DUMP_FORMATS = (
+    ("COGES_MYKEY_V1", "v1"),          # Save to File (.myk)
+    ("MyKey Raw Data Dump", "raw"),    # mykey_save_raw_data
+    ("=== DEBUG INFO ===", "debug"),   # mykey_debug_*.txt from the Debug Info scene
+)
+
+def sniff_format(first_line):
+    """Identify a dump format from its first line, None if unknown"""
+    for header, fmt in DUMP_FORMATS:
+        if first_line.startswith(header):
+            return fmt
+    return None
+
+def parse_block_line(fmt, line):
+    """(block_num, value) from a block line, or None. V1: BLOCK_033: XXXXXXXX, others: Block 0x21: 0xXXXXXXXX"""
     try:
-        with open(filename, 'r') as f:
-            lines = f.readlines()
-    except FileNotFoundError:
-        print(f"Error: File '{filename}' not found")
+        if fmt == "v1" and line.startswith("BLOCK_"):
+            num, val = line[6:].split(":", 1)
+            return int(num), int(val.strip(), 16)
+        if fmt != "v1" and line.startswith("Block 0x"):
+            num, val = line[8:].split(":", 1)
+            return int(num, 16), int(val.strip(), 16)
+    except ValueError:
+        pass
+    return None
+
+def read_dumps(filename):
+    """
+    Stream every dump record in a file, yield (format, uid, encryption_key, blocks).
+    Saves and captures hold one record, the device debug log appends many. Raises ValueError.
+    """
+    with open(filename, 'r', errors='replace') as f:
+        fmt = sniff_format(f.readline())
+        if fmt is None:
+            raise ValueError("Invalid file format (unknown header)")
+
+        uid = None
+        encryption_key = None
+        blocks = {}
+        # Debug captures list a few key blocks before the dump, only trust the dump itself
+        in_blocks = fmt != "debug"
+        for line in f:
+            line = line.strip()
+            next_fmt = sniff_format(line)
+            if next_fmt is not None:
+                yield finish_record(fmt, uid, encryption_key, blocks)
+                fmt, uid, encryption_key, blocks = next_fmt, None, None, {}
+                in_blocks = fmt != "debug"
+            elif uid is None and line.startswith("UID:"):
+                uid = int(line.split(":")[1].strip(), 16)
+            elif encryption_key is None and line.startswith(("ENCRYPTION_KEY:", "Encryption Key:")):
+                encryption_key = int(line.split(":")[1].strip(), 16)
+            elif line.startswith("--- Raw Data Dump ---"):
+                in_blocks = True
+            elif in_blocks and len(blocks) < 128:
+                parsed = parse_block_line(fmt, line)
+                if parsed and parsed[0] < 128:
+                    blocks[parsed[0]] = parsed[1]
+
+        yield finish_record(fmt, uid, encryption_key, blocks)
+
+def finish_record(fmt, uid, encryption_key, blocks):
+    if uid is None:
+        raise ValueError("Invalid file format (missing UID)")
+    if encryption_key is None:
+        raise ValueError("Invalid file format (missing encryption key)")
+    return fmt, uid, encryption_key, blocks
+
+def read_dump(filename):
+    """First dump record in a file, see read_dumps"""
+    return next(read_dumps(filename))
+
+def history_start(blocks):
+    """Starting offset of the transaction ring (0-7), or None if unavailable"""
+    block_3C = blocks.get(0x3C, 0xFFFFFFFF)
+    if block_3C == 0xFFFFFFFF:
+        return None
+    block_3C_decrypted = block_3C ^ blocks.get(0x07, 0)
+    starting_offset = ((block_3C_decrypted & 0x30000000) >> 28) | \
+                      ((block_3C_decrypted & 0x00100000) >> 18)
+    return starting_offset if starting_offset < 8 else None
+
+def summarize(filename, uid, encryption_key, blocks):
+    """One bulk row for a single dump (pure Python path)"""
+    credit = encode_decode_block(blocks.get(0x21, 0) ^ encryption_key) & 0xFFFF
+    start = history_start(blocks)
+    transactions = 0
+    history_credit = None
+    if start is not None:
+        history_credit = blocks.get(0x34 + start, 0xFFFFFFFF) & 0xFFFF
+        for i in range(8):
+            if blocks.get(0x34 + ((start + i) % 8), 0xFFFFFFFF) == 0xFFFFFFFF:
+                break
+            transactions += 1
+    return {
+        "file": filename,
+        "uid": f"{uid:016X}",
+        "encryption_key": f"{encryption_key:08X}",
+        "serial": f"{blocks.get(0x07, 0):08X}",
+        "credit": credit,
+        "history_credit": history_credit,
+        "op_count": blocks.get(0x12, 0) & 0x00FFFFFF,
+        "is_reset": blocks.get(0x18, 0) == 0x8FCD0F48 and blocks.get(0x19, 0) == 0xC0820007,
+        "transactions": transactions,
+    }
+
+def summarize_batch(files, uids, keys, images):
+    """Bulk rows for N dumps at once. images is an (N, 128) uint32 array."""
+    credit = encode_decode_array(images[:, 0x21] ^ keys) & np.uint32(0xFFFF)
+    op_count = images[:, 0x12] & np.uint32(0x00FFFFFF)
+    is_reset = (images[:, 0x18] == np.uint32(0x8FCD0F48)) & (images[:, 0x19] == np.uint32(0xC0820007))
+
+    block_3C = images[:, 0x3C]
+    decrypted = block_3C ^ images[:, 0x07]
+    start = ((decrypted & np.uint32(0x30000000)) >> 28) | ((decrypted & np.uint32(0x00100000)) >> 18)
+    has_history = (block_3C != np.uint32(0xFFFFFFFF)) & (start < 8)
+    start = np.where(has_history, start, 0).astype(np.intp)
+
+    ring = images[:, 0x34:0x3C]
+    order = (start[:, None] + np.arange(8)[None, :]) % 8
+    walked = np.take_along_axis(ring, order, axis=1)
+    empty = walked == np.uint32(0xFFFFFFFF)
+    # Transactions stop at the first empty slot
+    transactions = np.where(empty.any(axis=1), empty.argmax(axis=1), 8)
+    transactions = np.where(has_history, transactions, 0)
+    history_credit = walked[:, 0] & np.uint32(0xFFFF)
+
+    rows = []
+    for i, filename in enumerate(files):
+        rows.append({
+            "file": filename,
+            "uid": f"{int(uids[i]):016X}",
+            "encryption_key": f"{int(keys[i]):08X}",
+            "serial": f"{int(images[i, 0x07]):08X}",
+            "credit": int(credit[i]),
+            "history_credit": int(history_credit[i]) if has_history[i] else None,
+            "op_count": int(op_count[i]),
+            "is_reset": bool(is_reset[i]),
+            "transactions": int(transactions[i]),
+        })
+    return rows
+
+def summarize_native(files, uids, keys, images):
+    """Bulk rows for N dumps through the C decode core (mykey_native)"""
+    return summary_rows(files, mykey_native.summarize(images, uids, keys))
+
+def summary_rows(files, summary):
+    """Bulk rows from a mykey_native SUMMARY_DTYPE array"""
+    rows = []
+    for filename, s in zip(files, summary):
+        has_history = bool(s["flags"] & mykey_native.FLAG_HISTORY)
+        rows.append({
+            "file": filename,
+            "uid": f"{int(s['uid']):016X}",
+            "encryption_key": f"{int(s['encryption_key']):08X}",
+            "serial": f"{int(s['serial']):08X}",
+            "credit": int(s["credit"]),
+            "history_credit": int(s["history_credit"]) if has_history else None,
+            "op_count": int(s["op_count"]),
+            "is_reset": bool(s["flags"] & mykey_native.FLAG_RESET),
+            "transactions": int(s["transactions"]),
+        })
+    return rows
+
+def bulk_worker(filenames):
+    """Parse and decode one chunk of files. Returns (rows, errors)."""
+    parsed = []
+    errors = []
+    for filename in filenames:
+        try:
+            for index, (_, uid, encryption_key, blocks) in enumerate(read_dumps(filename)):
+                name = f"{filename}#{index}" if index else filename
+                if len(blocks) != 128:
+                    errors.append(f"{name}: expected 128 blocks, found {len(blocks)}")
+                    continue
+                parsed.append((name, uid, encryption_key, blocks))
+        except (OSError, ValueError) as e:
+            errors.append(f"{filename}: {e}")
+
+    if not parsed:
+        return [], errors
+
+    if np is None:
+        return [summarize(*p) for p in parsed], errors
+
+    files = [p[0] for p in parsed]
+    uids = np.array([p[1] for p in parsed], dtype=np.uint64)
+    keys = np.array([p[2] for p in parsed], dtype=np.uint32)
+    images = np.array([[p[3][i] for i in range(128)] for p in parsed], dtype=np.uint32)
+    if mykey_native is not None and mykey_native.available():
+        return summarize_native(files, uids, keys, images), errors
+    return summarize_batch(files, uids, keys, images), errors
+
+def collect_paths(patterns, extensions=("*.myk", "*.txt", "*.log")):
+    """Expand directories (recursively, dump extensions) and globs into a sorted file list"""
+    paths = set()
+    for pattern in patterns:
+        if os.path.isdir(pattern):
+            for ext in extensions:
+                paths.update(glob.glob(os.path.join(pattern, "**", ext), recursive=True))
+        elif os.path.isfile(pattern):
+            paths.add(pattern)
+        else:
+            paths.update(p for p in glob.glob(pattern, recursive=True) if os.path.isfile(p))
+    return sorted(paths)
+
+def hex_column(values, dtype):
+    """Fixed-width upper-case hex strings for an integer column, in one pass over its bytes"""
+    width = np.dtype(dtype).itemsize * 2
+    text = np.ascontiguousarray(values, dtype=dtype).tobytes().hex().upper().encode()
+    return np.frombuffer(text, dtype=f"S{width}").astype(f"U{width}")
+
+def archive_columns(path, threads):
+    """
+    BULK_COLUMNS arrays for a packed archive, decoded straight from the mapped images
+    (mykey_archive) and formatted column-wise, never one Python object per dump.
+    history_credit is a masked array, masked where the card has no history.
+    """
+    import mykey_archive
+    with mykey_archive.Archive(path) as archive:
+        summary = archive.summarize(threads)
+
+    flags = summary["flags"]
+    return {
+        "file": np.char.add(f"{path}#", np.arange(len(summary)).astype("U")),
+        "uid": hex_column(summary["uid"], ">u8"),
+        "encryption_key": hex_column(summary["encryption_key"], ">u4"),
+        "serial": hex_column(summary["serial"], ">u4"),
+        "credit": summary["credit"],
+        "history_credit": np.ma.masked_array(summary["history_credit"],
+                                             mask=(flags & mykey_native.FLAG_HISTORY) == 0),
+        "op_count": summary["op_count"],
+        "is_reset": (flags & mykey_native.FLAG_RESET) != 0,
+        "transactions": summary["transactions"],
+    }
+
+def csv_column(name, values):
+    """One archive column as CSV fields, written the way csv.DictWriter writes the row dicts"""
+    if isinstance(values, np.ma.MaskedArray):
+        return np.where(values.mask, "", values.data.astype("U"))
+    if values.dtype == bool:
+        return np.where(values, "True", "False")
+    values = values.astype("U")
+    if name == "file" and len(values) and any(c in values[0] for c in ',"\r\n'):
+        values = np.char.add(np.char.add('"', np.char.replace(values, '"', '""')), '"')
+    return values
+
+def parquet_table(rows, archives):
+    """Bulk rows and archive columns as one pyarrow table"""
+    import pyarrow as pa
+    schema = pa.schema([
+        ("file", pa.string()), ("uid", pa.string()), ("encryption_key", pa.string()),
+        ("serial", pa.string()), ("credit", pa.int64()), ("history_credit", pa.int64()),
+        ("op_count", pa.int64()), ("is_reset", pa.bool_()), ("transactions", pa.int64()),
+    ])
+    tables = [pa.Table.from_pylist(rows, schema=schema)]
+    for columns in archives:
+        arrays = []
+        for field in schema:
+            values = columns[field.name]
+            if isinstance(values, np.ma.MaskedArray):
+                arrays.append(pa.array(values.data, mask=values.mask, type=field.type))
+            else:
+                arrays.append(pa.array(values, type=field.type))
+        tables.append(pa.Table.from_arrays(arrays, schema=schema))
+    return pa.concat_tables(tables)
+
+def write_rows(rows, output, archives=()):
+    """
+    Write bulk rows, then the archive_columns of every archive, as CSV (stdout or file)
+    or Parquet (.parquet, needs pyarrow)
+    """
+    if output and output.endswith(".parquet"):
+        import pyarrow.parquet as pq
+        pq.write_table(parquet_table(rows, archives), output)
+        return
+
+    f = open(output, "w", newline="") if output else sys.stdout
+    try:
+        writer = csv.DictWriter(f, fieldnames=BULK_COLUMNS)
+        writer.writeheader()
+        writer.writerows(rows)
+        for columns in archives:
+            fields = [csv_column(name, columns[name]).tolist() for name in BULK_COLUMNS]
+            if fields[0]:
+                f.write("\r\n".join(map(",".join, zip(*fields))))
+                f.write("\r\n")
+    finally:
+        if output:
+            f.close()
+
+def run_bulk(patterns, output, jobs):
+    """Analyze many dumps in a process pool and emit one row per dump"""
+    paths = collect_paths(patterns)
+    archives = [p for p in paths if p.endswith(".mykpack")]
+    paths = [p for p in paths if not p.endswith(".mykpack")]
+    if not paths and not archives:
+        print("Error: no dump files found", file=sys.stderr)
         return False
-    except Exception as e:
-        print(f"Error reading file: {e}")
+
+    chunks = [paths[i:i + BULK_CHUNK_SIZE] for i in range(0, len(paths), BULK_CHUNK_SIZE)]
+    if jobs == 1 or len(chunks) <= 1:
+        results = [bulk_worker(chunk) for chunk in chunks]
+    else:
+        # Build the native library once here, not in every worker at the same time
+        if mykey_native is not None and np is not None:
+            mykey_native.available()
+        with Pool(min(jobs, len(chunks))) as pool:
+            results = pool.map(bulk_worker, chunks)
+
+    rows = []
+    errors = []
+    for chunk_rows, chunk_errors in results:
+        rows.extend(chunk_rows)
+        errors.extend(chunk_errors)
+
+    # Archives are already decoded images, they only need the native core
+    archive_tables = []
+    for path in archives:
+        if mykey_native is None or np is None or not mykey_native.available():
+            errors.append(f"{path}: archives need numpy and the native library")
+            continue
+        try:
+            archive_tables.append(archive_columns(path, jobs))
+        except (OSError, ValueError) as e:
+            errors.append(f"{path}: {e}")
+
+    write_rows(rows, output, archive_tables)
+
+    count = len(rows) + sum(len(columns["file"]) for columns in archive_tables)
+    for error in errors:
+        print(f"Warning: {error}", file=sys.stderr)
+    print(f"Processed {count} dumps ({len(errors)} skipped)", file=sys.stderr)
+    return True
+
+def charge_uah(current_ma, time_us):
+    """Battery charge drawn over time_us at current_ma"""
+    return current_ma * time_us / 3.6e6
+
+def replay_trace(filename, mode, baseline, repeat, compare=False):
+    """Replay one trace, print its report. False if it is unreadable or diverges from the recording."""
+    try:
+        with open(filename, "rb") as f:
+            data = f.read()
+        header, records = mykey_native.read_trace(data)
+        uid, image = baseline if baseline else (0, None)
+        result = mykey_native.replay(data, mode, image, uid)
+    except (OSError, ValueError) as e:
+        print(f"{filename}: error: {e}")
         return False
 
-    # Verify header
-    if not lines[0].startswith("COGES_MYKEY_V1"):
-        print("Error: Invalid file format (missing header)")
+    start = time.perf_counter()
+    for _ in range(repeat - 1):
+        mykey_native.replay(data, mode, image, uid)
+    elapsed = time.perf_counter() - start
+
+    recorded_mode = [name for name, value in mykey_native.READ_MODES.items()
+                     if value == header["mode"]]
+    ops = np.bincount(records["op"], minlength=len(mykey_native.TRACE_OPS))
+    failed_reads = int(np.count_nonzero((records["op"] == 1) & (records["error"] != 0)))
+
+    print(f"{filename}:")
+    print(f"  Recorded: {recorded_mode[0] if recorded_mode else header['mode']} read, "
+          f"{len(records)} ops ({', '.join(f'{n} {name}' for name, n in zip(mykey_native.TRACE_OPS, ops))}), "
+          f"{failed_reads} failed reads, {'completed' if result['recorded_done'] else 'not completed'}"
+          f"{', against a baseline' if header['flags'] & mykey_native.TRACE_FLAG_BASELINE else ''}"
+          f"{', TRUNCATED' if header['flags'] & mykey_native.TRACE_FLAG_TRUNCATED else ''}")
+    print(f"  Replayed: {result['mode']} read of UID 0x{result['uid']:016X}, {result['sessions']} sessions, "
+          f"{result['reads']} reads ({result['read_errors']} failed, {result['missing']} not in trace), "
+          f"{'completed' if result['done'] else 'not completed'}")
+    print(f"  Field time: {result['recorded_us'] / 1000:.1f} ms recorded, "
+          f"{result['estimated_us'] / 1000:.1f} ms estimated for the replayed reads")
+    if result["current_ma"]:
+        print(f"  Energy: {result['current_ma']} mA at {result['voltage_mv']} mV with the field up, "
+              f"{charge_uah(result['current_ma'], result['recorded_us']):.2f} uAh recorded, "
+              f"{charge_uah(result['current_ma'], result['estimated_us']):.2f} uAh estimated")
+    if result["done"]:
+        print(f"  Card: key 0x{result['encryption_key']:08X}, credit {result['credit'] / 100:.2f} EUR, "
+              f"{result['blocks_read']} blocks read, {result['blocks_changed']} changed")
+    if repeat > 1:
+        print(f"  Replay: {elapsed / (repeat - 1) * 1e6:.1f} us per run over {repeat - 1} runs")
+    if compare:
+        # Same exchange under every strategy, energy at the recorded current
+        print("  Mode         reads  field ms      uAh  completed")
+        for name in mykey_native.READ_MODES:
+            other = mykey_native.replay(data, name, image, uid)
+            print(f"  {name:<12} {other['reads']:>5} {other['estimated_us'] / 1000:>9.1f} "
+                  f"{charge_uah(result['current_ma'], other['estimated_us']):>8.2f}  "
+                  f"{'yes' if other['done'] else 'no'}")
+
+    # Same strategy as recorded must reach the same outcome
+    if mode is None and header["flags"] & mykey_native.TRACE_FLAG_BASELINE and baseline is None:
+        print("  Outcome not checked: recorded against a baseline, pass it with --baseline")
+    elif mode is None and result["done"] != result["recorded_done"]:
+        print("  MISMATCH: replay outcome differs from the recording")
+        return False
+    return True
+
+def run_replay(paths, mode, baseline_path, repeat, compare=False):
+    """Replay recorded NFC exchanges through the firmware read pipeline"""
+    if mykey_native is None or np is None or not mykey_native.available():
+        print("Error: trace replay needs numpy and the native library (see mykey_native.py)",
+              file=sys.stderr)
         return False
 
-    # Parse UID
-    uid_line = lines[1].strip()
-    if not uid_line.startswith("UID:"):
-        print("Error: Invalid file format (missing UID)")
+    baseline = None
+    if baseline_path:
+        try:
+            _, uid, _, blocks = read_dump(baseline_path)
+        except (OSError, ValueError) as e:
+            print(f"Error: baseline {baseline_path}: {e}", file=sys.stderr)
+            return False
+        baseline = (uid, np.array([blocks.get(i, 0) for i in range(128)], dtype=np.uint32))
+
+    paths = collect_paths(paths, ("*.mktr",))
+    if not paths:
+        print("Error: no trace files found", file=sys.stderr)
         return False
-    uid = int(uid_line.split(":")[1].strip(), 16)
 
-    # Parse encryption key
-    key_line = lines[2].strip()
-    if not key_line.startswith("ENCRYPTION_KEY:"):
-        print("Error: Invalid file format (missing encryption key)")
+    ok = True
+    for path in paths:
+        ok = replay_trace(path, mode, baseline, max(1, repeat), compare) and ok
+    return ok
+
+def parse_mykey_file(filename):
+    """Parse a .myk file and display its contents"""
+    try:
+        fmt, uid, encryption_key, blocks = read_dump(filename)
+    except FileNotFoundError:
+        print(f"Error: File '{filename}' not found")
+        return False
+    except ValueError as e:
+        print(f"Error: {e}")
+        return False
+    except Exception as e:
+        print(f"Error reading file: {e}")
         return False
-    encryption_key = int(key_line.split(":")[1].strip(), 16)
-
-    # Parse blocks
-    blocks = {}
-    for line in lines[3:]:
-        line = line.strip()
-        if line.startswith("BLOCK_"):
-            parts = line.split(":")
-            block_num = int(parts[0].split("_")[1])
-            block_val = int(parts[1].strip(), 16)
-            blocks[block_num] = block_val
 
     if len(blocks) != 128:
         print(f"Warning: Expected 128 blocks, found {len(blocks)}")
@@ -70,7 +504,8 @@ def parse_mykey_file(filename):
     print("=" * 60)
     print(" COGES MyKey Card Information")
     print("=" * 60)
-    print(f"\nUID: 0x{uid:016X}")
+    print(f"\nFormat: {fmt}")
+    print(f"UID: 0x{uid:016X}")
     print(f"Encryption Key: 0x{encryption_key:08X}")
 
     # Serial number (block 0x07 in BCD format)
@@ -96,38 +531,31 @@ def parse_mykey_file(filename):
     print(f"Status: {'Reset' if is_reset else 'Active'}")
 
     # Parse transaction history
-    block_3C = blocks.get(0x3C, 0xFFFFFFFF)
-    block_07 = blocks.get(0x07, 0)
-
-    if block_3C != 0xFFFFFFFF:
-        block_3C_decrypted = block_3C ^ block_07
-        starting_offset = ((block_3C_decrypted & 0x30000000) >> 28) | \
-                         ((block_3C_decrypted & 0x00100000) >> 18)
-
-        if starting_offset < 8:
-            # Count transactions
-            transactions = []
-            for i in range(8):
-                txn_block = blocks.get(0x34 + ((starting_offset + i) % 8), 0xFFFFFFFF)
-                if txn_block == 0xFFFFFFFF:
-                    break
-
-                day = txn_block >> 27
-                month = (txn_block >> 23) & 0xF
-                year = 2000 + ((txn_block >> 16) & 0x7F)
-                credit = txn_block & 0xFFFF
-
-                transactions.append({
-                    'date': f"{day:02d}/{month:02d}/{year}",
-                    'credit': credit
-                })
-
-            if transactions:
-                print("\n" + "=" * 60)
-                print(" Transaction History (Newest First)")
-                print("=" * 60)
-                for i, txn in enumerate(reversed(transactions), 1):
-                    print(f"{i}. {txn['date']} - {txn['credit']} cents ({txn['credit']/100:.2f} EUR)")
+    starting_offset = history_start(blocks)
+    if starting_offset is not None:
+        # Count transactions
+        transactions = []
+        for i in range(8):
+            txn_block = blocks.get(0x34 + ((starting_offset + i) % 8), 0xFFFFFFFF)
+            if txn_block == 0xFFFFFFFF:
+                break
+
+            day = txn_block >> 27
+            month = (txn_block >> 23) & 0xF
+            year = 2000 + ((txn_block >> 16) & 0x7F)
+            credit = txn_block & 0xFFFF
+
+            transactions.append({
+                'date': f"{day:02d}/{month:02d}/{year}",
+                'credit': credit
+            })
+
+        if transactions:
+            print("\n" + "=" * 60)
+            print(" Transaction History (Newest First)")
+            print("=" * 60)
+            for i, txn in enumerate(reversed(transactions), 1):
+                print(f"{i}. {txn['date']} - {txn['credit']} cents ({txn['credit']/100:.2f} EUR)")
 
     # Display interesting blocks
     print("\n" + "=" * 60)
@@ -141,13 +569,32 @@ def parse_mykey_file(filename):
     return True
 
 def main():
-    if len(sys.argv) < 2:
-        print("Usage: python3 parse_mykey_file.py <file.myk>")
-        print("\nThis script parses COGES MyKey files created by the Flipper Zero app")
-        print("and displays card information in a human-readable format.")
-        sys.exit(1)
+    parser = argparse.ArgumentParser(
+        description="Parse COGES MyKey files created by the Flipper Zero app "
+                    "and display card information in a human-readable format.")
+    parser.add_argument("paths", nargs="+", help="dump file (or files, directories, globs with --bulk)")
+    parser.add_argument("--bulk", action="store_true", help="analyze many dumps, one output row per dump")
+    parser.add_argument("-o", "--output", help="bulk output file (.csv or .parquet, default: CSV on stdout)")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1, help="bulk worker processes")
+    parser.add_argument("--replay", action="store_true", help="replay .mktr NFC traces through the read pipeline")
+    parser.add_argument("--mode", choices=["full", "quick", "incremental"],
+                        help="replay with another read mode (default: the recorded one)")
+    parser.add_argument("--compare", action="store_true",
+                        help="also replay with every read mode and compare field time and energy")
+    parser.add_argument("--baseline", help="previous dump of the card for --mode incremental")
+    parser.add_argument("--repeat", type=int, default=1, help="replay each trace N times and report the time per run")
+    args = parser.parse_args()
+
+    if args.replay:
+        sys.exit(0 if run_replay(args.paths, args.mode, args.baseline, args.repeat, args.compare) else 1)
+
+    if args.bulk:
+        sys.exit(0 if run_bulk(args.paths, args.output, max(1, args.jobs)) else 1)
+
+    if len(args.paths) != 1:
+        parser.error("multiple paths need --bulk")
 
-    filename = sys.argv[1]
+    filename = args.paths[0]
     if parse_mykey_file(filename):
         print("\n" + "=" * 60)
         print(" Parsing completed successfully")
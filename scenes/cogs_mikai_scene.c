@@ -1,6 +1,21 @@
 #include "../cogs_mikai.h"
 
-#define ADD_SCENE(prefix, name, id) prefix##_scene_##name##_on_enter,
+// Wrap every scene's enter/exit with heap and stack sampling
+#define ADD_SCENE(prefix, name, id)                                                     \
+    static void prefix##_scene_##name##_on_enter_sampled(void* context) {               \
+        cogs_mikai_memstat_sample(context, COGSMyKaiScene##id, MyKeyMemStatBeforeEnter); \
+        prefix##_scene_##name##_on_enter(context);                                      \
+        cogs_mikai_memstat_sample(context, COGSMyKaiScene##id, MyKeyMemStatAfterEnter);  \
+    }                                                                                   \
+    static void prefix##_scene_##name##_on_exit_sampled(void* context) {                \
+        cogs_mikai_memstat_sample(context, COGSMyKaiScene##id, MyKeyMemStatBeforeExit);  \
+        prefix##_scene_##name##_on_exit(context);                                       \
+        cogs_mikai_memstat_sample(context, COGSMyKaiScene##id, MyKeyMemStatAfterExit);   \
+    }
+#include "cogs_mikai_scene_config.c"
+#undef ADD_SCENE
+
+#define ADD_SCENE(prefix, name, id) prefix##_scene_##name##_on_enter_sampled,
 void (* const cogs_mikai_scene_on_enter_handlers[])(void*) = {
 #include "cogs_mikai_scene_config.c"
 };
@@ -12,7 +27,7 @@ bool (* const cogs_mikai_scene_on_event_handlers[])(void*, SceneManagerEvent) =
 };
 #undef ADD_SCENE
 
-#define ADD_SCENE(prefix, name, id) prefix##_scene_##name##_on_exit,
+#define ADD_SCENE(prefix, name, id) prefix##_scene_##name##_on_exit_sampled,
 void (* const cogs_mikai_scene_on_exit_handlers[])(void*) = {
 #include "cogs_mikai_scene_config.c"
 };
@@ -1,13 +1,6 @@
 #include "../cogs_mikai.h"
 #include <furi_hal_rtc.h>
 
-enum {
-    AddCreditSceneEventInput,
-    AddCreditSceneEventWrite,
-    AddCreditSceneEventSave,
-    AddCreditSceneEventDiscard,
-};
-
 static bool cogs_mikai_scene_add_credit_validator(const char* text, FuriString* error, void* context) {
     UNUSED(context);
 
@@ -68,12 +61,12 @@ static bool parse_euros_to_cents(const char* text, uint16_t* cents) {
 
 static void cogs_mikai_scene_add_credit_text_input_callback(void* context) {
     COGSMyKaiApp* app = context;
-    view_dispatcher_send_custom_event(app->view_dispatcher, AddCreditSceneEventInput);
+    view_dispatcher_send_custom_event(app->view_dispatcher, COGSMyKaiCustomEventTextInput);
 }
 
 static void cogs_mikai_scene_add_credit_popup_callback(void* context) {
     COGSMyKaiApp* app = context;
-    view_dispatcher_send_custom_event(app->view_dispatcher, 0);
+    view_dispatcher_send_custom_event(app->view_dispatcher, COGSMyKaiCustomEventPopupClosed);
 }
 
 void cogs_mikai_scene_add_credit_on_enter(void* context) {
@@ -112,7 +105,7 @@ bool cogs_mikai_scene_add_credit_on_event(void* context, SceneManagerEvent event
     bool consumed = false;
 
     if(event.type == SceneManagerEventTypeCustom) {
-        if(event.event == AddCreditSceneEventInput) {
+        if(event.event == COGSMyKaiCustomEventTextInput) {
             if(app->text_buffer[0] == '\0') {
                 FURI_LOG_W(TAG, "Ignoring empty text_buffer (already processed)");
                 consumed = true;
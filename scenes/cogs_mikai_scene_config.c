@@ -1,5 +1,6 @@
 ADD_SCENE(cogs_mikai, start, Start)
 ADD_SCENE(cogs_mikai, read, Read)
+ADD_SCENE(cogs_mikai, scan, Scan)
 ADD_SCENE(cogs_mikai, info, Info)
 ADD_SCENE(cogs_mikai, write_card, WriteCard)
 ADD_SCENE(cogs_mikai, add_credit, AddCredit)
@@ -1,11 +1,5 @@
 #include "../cogs_mikai.h"
-#include <storage/storage.h>
 #include <machine/endian.h>
-#include <furi_hal_rtc.h>
-
-enum {
-    DebugSceneEventSaveData = 1,
-};
 
 void cogs_mikai_scene_debug_on_enter(void* context) {
     COGSMyKaiApp* app = context;
@@ -15,7 +9,9 @@ void cogs_mikai_scene_debug_on_enter(void* context) {
     furi_string_reset(text);
 
     if(!app->mykey.is_loaded) {
-        furi_string_cat(text, "No Card Loaded\n\nPlease read a card first.");
+        furi_string_cat(text, "No Card Loaded\n\nPlease read a card first.\n\n");
+        cogs_mikai_memstat_format(app, text);
+        cogs_mikai_energy_format(app, text);
     } else {
         furi_string_cat(text, "=== DEBUG INFO ===\n\n");
 
@@ -108,59 +104,32 @@ void cogs_mikai_scene_debug_on_enter(void* context) {
         furi_string_cat_printf(text, "Block 0x21: 0x%08lX\n", app->mykey.eeprom[0x21]);
         furi_string_cat_printf(text, "Block 0x3C: 0x%08lX\n\n", app->mykey.eeprom[0x3C]);
 
-        furi_string_cat(text, "\n--- Raw data saved in SD ---\n");
-        furi_string_cat(text, "Use back to exit, or\n");
-        furi_string_cat(text, "check logs for raw data");
+        cogs_mikai_memstat_format(app, text);
+        cogs_mikai_energy_format(app, text);
+
+        // raw dump goes to the opt-in debug log, once per distinct dump
+        switch(mykey_debug_log_append(&app->debug_log, &app->mykey)) {
+            case MyKeyDebugLogWritten:
+                furi_string_cat(text, "\n--- Raw data logged ---\n");
+                furi_string_cat(text, "apps_data/cogs_mikai/debug.log");
+                break;
+            case MyKeyDebugLogDuplicate:
+                furi_string_cat(text, "\n--- Already in debug log ---\n");
+                break;
+            case MyKeyDebugLogDisabled:
+                furi_string_cat(text, "\n--- Debug log off ---\n");
+                furi_string_cat(text, "Enable it in the main menu");
+                break;
+            case MyKeyDebugLogError:
+                furi_string_cat(text, "\n--- Debug log write failed ---\n");
+                break;
+        }
     }
 
     text_box_set_text(text_box, furi_string_get_cstr(text));
     text_box_set_font(text_box, TextBoxFontText);
     text_box_set_focus(text_box, TextBoxFocusStart);
 
-
-    if(app->mykey.is_loaded) {
-        DateTime datetime;
-        furi_hal_rtc_get_datetime(&datetime);
-
-        FuriString* file_path = furi_string_alloc();
-        furi_string_printf(
-            file_path,
-            "/ext/mykey_debug_%04d%02d%02d_%02d%02d%02d.txt",
-            datetime.year,
-            datetime.month,
-            datetime.day,
-            datetime.hour,
-            datetime.minute,
-            datetime.second);
-
-        Storage* storage = furi_record_open(RECORD_STORAGE);
-        File* file = storage_file_alloc(storage);
-
-        if(storage_file_open(file, furi_string_get_cstr(file_path), FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
-
-            storage_file_write(file, furi_string_get_cstr(text), furi_string_size(text));
-
-       
-            storage_file_write(file, "\n\n--- Raw Data Dump ---\n", strlen("\n\n--- Raw Data Dump ---\n"));
-
-            FuriString* line = furi_string_alloc();
-            for(size_t i = 0; i < SRIX4K_BLOCKS; i++) {
-                furi_string_printf(line, "Block 0x%02zX: 0x%08lX\n", i, app->mykey.eeprom[i]);
-                storage_file_write(file, furi_string_get_cstr(line), furi_string_size(line));
-            }
-            furi_string_free(line);
-
-            FURI_LOG_I(TAG, "Debug data saved to: %s", furi_string_get_cstr(file_path));
-            storage_file_close(file);
-        } else {
-            FURI_LOG_E(TAG, "Failed to save debug data");
-        }
-
-        storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
-        furi_string_free(file_path);
-    }
-
     view_dispatcher_switch_to_view(app->view_dispatcher, COGSMyKaiViewTextBox);
 }
 
@@ -1,42 +1,108 @@
 #include "../cogs_mikai.h"
 
-static void cogs_mikai_scene_read_popup_callback(void* context) {
+// Give up when no card has been read for this long, or after this many interrupted sessions
+#define READ_SCENE_TIMEOUT_MS 10000
+#define READ_SCENE_MAX_FAILURES 3
+
+// Called from the NFC worker thread, hand over to the GUI thread
+static void cogs_mikai_scene_read_callback(MyKeyReaderEvent event, void* context) {
     COGSMyKaiApp* app = context;
-    view_dispatcher_send_custom_event(app->view_dispatcher, 0);
+    uint32_t scene_event = COGSMyKaiCustomEventReadProgress;
+    if(event == MyKeyReaderEventDone) {
+        scene_event = COGSMyKaiCustomEventReadDone;
+    } else if(event == MyKeyReaderEventFailed) {
+        scene_event = COGSMyKaiCustomEventReadFailed;
+    }
+    view_dispatcher_send_custom_event(app->view_dispatcher, scene_event);
 }
 
-void cogs_mikai_scene_read_on_enter(void* context) {
+static void cogs_mikai_scene_read_timer_callback(void* context) {
     COGSMyKaiApp* app = context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, COGSMyKaiCustomEventReadTimeout);
+}
+
+static void cogs_mikai_scene_read_popup_callback(void* context) {
+    COGSMyKaiApp* app = context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, COGSMyKaiCustomEventPopupClosed);
+}
+
+// Stop polling and report why, the popup returns to the menu
+static void cogs_mikai_scene_read_fail(COGSMyKaiApp* app, const char* reason) {
+    app->read_finished = true;
+    furi_timer_stop(app->read_timer);
+    mykey_reader_stop(app->reader);
+    notification_message(app->notifications, &sequence_blink_stop);
+    notification_message(app->notifications, &sequence_error);
 
-    // Show popup for card detection
     Popup* popup = app->popup;
-    popup_set_header(popup, "Reading Card", 64, 10, AlignCenter, AlignTop);
-    popup_set_text(popup, "Place COGES MyKey\non Flipper's back", 64, 25, AlignCenter, AlignTop);
+    popup_set_header(popup, "Error", 64, 10, AlignCenter, AlignTop);
+    popup_set_text(popup, reason, 64, 25, AlignCenter, AlignTop);
     popup_set_icon(popup, 0, 0, NULL);
     popup_set_callback(popup, cogs_mikai_scene_read_popup_callback);
     popup_set_context(popup, app);
     popup_set_timeout(popup, 3000);
     popup_enable_timeout(popup);
-
     view_dispatcher_switch_to_view(app->view_dispatcher, COGSMyKaiViewPopup);
+}
 
-    // Attempt to read NFC card
-    if(mykey_read_from_nfc(app)) {
-        // Calculate encryption key
-        mykey_calculate_encryption_key(&app->mykey);
-        app->mykey.is_loaded = true;
-        app->mykey.is_modified = false;  // Fresh read from card
-        app->mykey.is_reset = mykey_is_reset(&app->mykey);
-        app->mykey.current_credit = mykey_get_current_credit(&app->mykey);
+// Show whatever has been decoded so far, the key and credit come in first
+static void cogs_mikai_scene_read_show_progress(COGSMyKaiApp* app) {
+    MyKeyData* card = app->reader_card;
+    MyKeyReaderStatus status;
+    uint32_t stages = mykey_reader_get_card(app->reader, card, &status);
 
-        popup_set_header(popup, "Success!", 64, 10, AlignCenter, AlignTop);
-        popup_set_text(popup, "Card read successfully", 64, 25, AlignCenter, AlignTop);
-        notification_message(app->notifications, &sequence_success);
-    } else {
-        popup_set_header(popup, "Error", 64, 10, AlignCenter, AlignTop);
-        popup_set_text(popup, "Failed to read card\nsegmentaion fault", 64, 25, AlignCenter, AlignTop);
-        notification_message(app->notifications, &sequence_error);
+    FuriString* text = app->text_box_store;
+    furi_string_printf(
+        text,
+        "Reading Card...\nKeep it still!\n\nBlocks: %u/%u\n",
+        status.blocks_read,
+        status.blocks_planned);
+    if(status.blocks_read > 0) {
+        furi_string_cat_printf(text, "UID: %016llX\n", card->uid);
     }
+    if(stages & MYKEY_PIPELINE_KEY) {
+        furi_string_cat_printf(text, "Key: %08lX\n", card->encryption_key);
+    }
+    if(stages & MYKEY_PIPELINE_CREDIT) {
+        furi_string_cat_printf(
+            text, "Credit: %d.%02d EUR\n", card->current_credit / 100, card->current_credit % 100);
+    }
+    text_box_set_text(app->text_box, furi_string_get_cstr(text));
+}
+
+// Scene state selects the MyKeyReadMode, set by the start menu
+void cogs_mikai_scene_read_on_enter(void* context) {
+    COGSMyKaiApp* app = context;
+    MyKeyReadMode mode = scene_manager_get_scene_state(app->scene_manager, COGSMyKaiSceneRead);
+    TextBox* text_box = app->text_box;
+    FuriString* text = app->text_box_store;
+
+    furi_string_set(text, "Reading Card\n\nPlace COGES MyKey\non Flipper's back");
+    text_box_set_text(text_box, furi_string_get_cstr(text));
+    text_box_set_font(text_box, TextBoxFontText);
+    text_box_set_focus(text_box, TextBoxFocusStart);
+    view_dispatcher_switch_to_view(app->view_dispatcher, COGSMyKaiViewTextBox);
+
+    app->reader_card = malloc(sizeof(MyKeyData));
+    app->reader = mykey_reader_alloc();
+    // Only the card in memory serves as a baseline, saved dumps are not looked up by UID.
+    // Local edits are not on the card, diffing against them would merge stale blocks
+    if(mode == MyKeyReadModeIncremental && app->mykey.is_loaded && !app->mykey.is_modified) {
+        mykey_reader_set_baseline(app->reader, &app->mykey);
+    }
+    mykey_reader_set_energy(app->reader, app->energy_stats);
+    if(app->trace_capture) {
+        app->trace = malloc(sizeof(MyKeyTrace));
+        mykey_reader_set_trace(app->reader, app->trace);
+    }
+    app->read_failures = 0;
+    app->read_finished = false;
+    app->read_timer =
+        furi_timer_alloc(cogs_mikai_scene_read_timer_callback, FuriTimerTypeOnce, app);
+    furi_timer_start(app->read_timer, furi_ms_to_ticks(READ_SCENE_TIMEOUT_MS));
+
+    mykey_reader_start(app->reader, mode, false, cogs_mikai_scene_read_callback, app);
+    notification_message(app->notifications, &sequence_blink_start_cyan);
 }
 
 bool cogs_mikai_scene_read_on_event(void* context, SceneManagerEvent event) {
@@ -45,7 +111,43 @@ bool cogs_mikai_scene_read_on_event(void* context, SceneManagerEvent event) {
 
     if(event.type == SceneManagerEventTypeCustom) {
         consumed = true;
-        scene_manager_previous_scene(app->scene_manager);
+        if(event.event == COGSMyKaiCustomEventPopupClosed) {
+            scene_manager_previous_scene(app->scene_manager);
+        } else if(app->read_finished) {
+            // Drop what the reader or the timer queued before they stopped
+        } else if(event.event == COGSMyKaiCustomEventReadProgress) {
+            // Blocks are coming in, the timeout only covers a reader that is stuck
+            furi_timer_start(app->read_timer, furi_ms_to_ticks(READ_SCENE_TIMEOUT_MS));
+            cogs_mikai_scene_read_show_progress(app);
+        } else if(event.event == COGSMyKaiCustomEventReadFailed) {
+            if(++app->read_failures >= READ_SCENE_MAX_FAILURES) {
+                cogs_mikai_scene_read_fail(app, "Failed to read card\nHold it still");
+            }
+        } else if(event.event == COGSMyKaiCustomEventReadTimeout) {
+            cogs_mikai_scene_read_fail(app, "No card found");
+        } else if(event.event == COGSMyKaiCustomEventReadDone) {
+            app->read_finished = true;
+            furi_timer_stop(app->read_timer);
+            MyKeyReaderStatus status;
+            mykey_reader_get_card(app->reader, &app->mykey, &status);
+            app->mykey.is_modified = false; // Fresh read from card
+            notification_message(app->notifications, &sequence_blink_stop);
+            notification_message(app->notifications, &sequence_success);
+
+            FuriString* text = app->text_box_store;
+            furi_string_set(text, "Card read successfully\n");
+            if(status.incremental) {
+                furi_string_cat_printf(
+                    text,
+                    "Re-read %u blocks, %u changed\n",
+                    status.blocks_read,
+                    status.blocks_changed);
+            }
+            furi_string_cat(text, "\n");
+            cogs_mikai_scene_info_format(&app->mykey, text);
+            text_box_set_text(app->text_box, furi_string_get_cstr(text));
+            text_box_set_focus(app->text_box, TextBoxFocusStart);
+        }
     }
 
     return consumed;
@@ -53,5 +155,27 @@ bool cogs_mikai_scene_read_on_event(void* context, SceneManagerEvent event) {
 
 void cogs_mikai_scene_read_on_exit(void* context) {
     COGSMyKaiApp* app = context;
+
+    furi_timer_free(app->read_timer);
+    app->read_timer = NULL;
+
+    // Leaving mid-read discards the partial card, app->mykey is only set when done
+    mykey_reader_free(app->reader);
+    app->reader = NULL;
+
+    // Saved whether or not the read completed, failing reads are the ones worth replaying
+    if(app->trace) {
+        if(app->trace->header.count > 0) {
+            mykey_trace_save(app->trace);
+        }
+        free(app->trace);
+        app->trace = NULL;
+    }
+    free(app->reader_card);
+    app->reader_card = NULL;
+    notification_message(app->notifications, &sequence_blink_stop);
+
     popup_reset(app->popup);
+    text_box_reset(app->text_box);
+    furi_string_reset(app->text_box_store);
 }
@@ -2,7 +2,7 @@
 
 static void cogs_mikai_scene_reset_popup_callback(void* context) {
     COGSMyKaiApp* app = context;
-    view_dispatcher_send_custom_event(app->view_dispatcher, 0);
+    view_dispatcher_send_custom_event(app->view_dispatcher, COGSMyKaiCustomEventPopupClosed);
 }
 
 void cogs_mikai_scene_reset_on_enter(void* context) {
@@ -42,7 +42,8 @@ bool cogs_mikai_scene_reset_on_event(void* context, SceneManagerEvent event) {
     COGSMyKaiApp* app = context;
     bool consumed = false;
 
-    if(event.type == SceneManagerEventTypeCustom) {
+    if(event.type == SceneManagerEventTypeCustom &&
+       event.event == COGSMyKaiCustomEventPopupClosed) {
         consumed = true;
         // Search back to start scene and switch (forces menu rebuild)
         scene_manager_search_and_switch_to_previous_scene(app->scene_manager, COGSMyKaiSceneStart);
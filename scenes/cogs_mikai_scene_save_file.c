@@ -3,10 +3,6 @@
 #include <storage/storage.h>
 #include <toolbox/path.h>
 
-enum {
-    SaveFileSceneEventInput,
-};
-
 static bool cogs_mikai_scene_save_file_validator(const char* text, FuriString* error, void* context) {
     UNUSED(context);
 
@@ -28,12 +24,12 @@ static bool cogs_mikai_scene_save_file_validator(const char* text, FuriString* e
 
 static void cogs_mikai_scene_save_file_text_input_callback(void* context) {
     COGSMyKaiApp* app = context;
-    view_dispatcher_send_custom_event(app->view_dispatcher, SaveFileSceneEventInput);
+    view_dispatcher_send_custom_event(app->view_dispatcher, COGSMyKaiCustomEventTextInput);
 }
 
 static void cogs_mikai_scene_save_file_popup_callback(void* context) {
     COGSMyKaiApp* app = context;
-    view_dispatcher_send_custom_event(app->view_dispatcher, 0);
+    view_dispatcher_send_custom_event(app->view_dispatcher, COGSMyKaiCustomEventPopupClosed);
 }
 
 void cogs_mikai_scene_save_file_on_enter(void* context) {
@@ -72,7 +68,7 @@ bool cogs_mikai_scene_save_file_on_event(void* context, SceneManagerEvent event)
     bool consumed = false;
 
     if(event.type == SceneManagerEventTypeCustom) {
-        if(event.event == SaveFileSceneEventInput) {
+        if(event.event == COGSMyKaiCustomEventTextInput) {
             if(app->text_buffer[0] == '\0') {
                 FURI_LOG_W(TAG, "Ignoring empty text_buffer (already processed)");
                 consumed = true;
@@ -0,0 +1,61 @@
+#include "../cogs_mikai.h"
+
+// Called from the NFC worker thread, hand over to the GUI thread
+static void cogs_mikai_scene_scan_callback(MyKeyReaderEvent event, void* context) {
+    COGSMyKaiApp* app = context;
+    // Only the quick view blocks are read, show the card once they are all in
+    if(event == MyKeyReaderEventDone) {
+        view_dispatcher_send_custom_event(app->view_dispatcher, COGSMyKaiCustomEventScanCard);
+    }
+}
+
+void cogs_mikai_scene_scan_on_enter(void* context) {
+    COGSMyKaiApp* app = context;
+    TextBox* text_box = app->text_box;
+    FuriString* text = app->text_box_store;
+
+    furi_string_set(text, "Scan Mode\n\nTap a COGES MyKey on\nFlipper's back to view it.\n\nRead-only, cards are\nnot loaded for editing.");
+    text_box_set_text(text_box, furi_string_get_cstr(text));
+    text_box_set_font(text_box, TextBoxFontText);
+    text_box_set_focus(text_box, TextBoxFocusStart);
+    view_dispatcher_switch_to_view(app->view_dispatcher, COGSMyKaiViewTextBox);
+
+    app->reader_card = malloc(sizeof(MyKeyData));
+    app->reader = mykey_reader_alloc();
+    mykey_reader_set_energy(app->reader, app->energy_stats);
+    mykey_reader_start(app->reader, MyKeyReadModeQuick, true, cogs_mikai_scene_scan_callback, app);
+    notification_message(app->notifications, &sequence_blink_start_cyan);
+}
+
+bool cogs_mikai_scene_scan_on_event(void* context, SceneManagerEvent event) {
+    COGSMyKaiApp* app = context;
+    bool consumed = false;
+
+    if(event.type == SceneManagerEventTypeCustom && event.event == COGSMyKaiCustomEventScanCard) {
+        if(mykey_reader_get_card(app->reader, app->reader_card, NULL) & MYKEY_PIPELINE_INFO) {
+            // Refresh the view in place, the field stays up for the next tap
+            FuriString* text = app->text_box_store;
+            furi_string_reset(text);
+            cogs_mikai_scene_info_format(app->reader_card, text);
+            text_box_set_text(app->text_box, furi_string_get_cstr(text));
+            text_box_set_focus(app->text_box, TextBoxFocusStart);
+            notification_message(app->notifications, &sequence_success);
+        }
+        consumed = true;
+    }
+
+    return consumed;
+}
+
+void cogs_mikai_scene_scan_on_exit(void* context) {
+    COGSMyKaiApp* app = context;
+
+    mykey_reader_free(app->reader);
+    app->reader = NULL;
+    free(app->reader_card);
+    app->reader_card = NULL;
+    notification_message(app->notifications, &sequence_blink_stop);
+
+    text_box_reset(app->text_box);
+    furi_string_reset(app->text_box_store);
+}
@@ -1,10 +1,6 @@
 #include "../cogs_mikai.h"
 #include <furi_hal_rtc.h>
 
-enum {
-    SetCreditSceneEventInput,
-};
-
 static bool cogs_mikai_scene_set_credit_validator(const char* text, FuriString* error, void* context) {
     UNUSED(context);
 
@@ -65,12 +61,12 @@ static bool parse_euros_to_cents(const char* text, uint16_t* cents) {
 
 static void cogs_mikai_scene_set_credit_text_input_callback(void* context) {
     COGSMyKaiApp* app = context;
-    view_dispatcher_send_custom_event(app->view_dispatcher, SetCreditSceneEventInput);
+    view_dispatcher_send_custom_event(app->view_dispatcher, COGSMyKaiCustomEventTextInput);
 }
 
 static void cogs_mikai_scene_set_credit_popup_callback(void* context) {
     COGSMyKaiApp* app = context;
-    view_dispatcher_send_custom_event(app->view_dispatcher, 0);
+    view_dispatcher_send_custom_event(app->view_dispatcher, COGSMyKaiCustomEventPopupClosed);
 }
 
 void cogs_mikai_scene_set_credit_on_enter(void* context) {
@@ -109,7 +105,7 @@ bool cogs_mikai_scene_set_credit_on_event(void* context, SceneManagerEvent event
     bool consumed = false;
 
     if(event.type == SceneManagerEventTypeCustom) {
-        if(event.event == SetCreditSceneEventInput) {
+        if(event.event == COGSMyKaiCustomEventTextInput) {
             if(app->text_buffer[0] == '\0') {
                 FURI_LOG_W(TAG, "Ignoring empty text_buffer (already processed)");
                 consumed = true;
@@ -2,6 +2,8 @@
 
 typedef enum {
     SubmenuIndexRead,
+    SubmenuIndexReRead,
+    SubmenuIndexScan,
     SubmenuIndexInfo,
     SubmenuIndexWriteCard,
     SubmenuIndexAddCredit,
@@ -10,12 +12,16 @@ typedef enum {
     SubmenuIndexSaveFile,
     SubmenuIndexLoadFile,
     SubmenuIndexDebug,
+    SubmenuIndexDebugLog,
+    SubmenuIndexTraceCapture,
     SubmenuIndexAbout,
 } SubmenuIndex;
 
+// Runs on the GUI thread while the menu is shown, other threads never send this event
 static void cogs_mikai_scene_start_submenu_callback(void* context, uint32_t index) {
     COGSMyKaiApp* app = context;
-    view_dispatcher_send_custom_event(app->view_dispatcher, index);
+    scene_manager_set_scene_state(app->scene_manager, COGSMyKaiSceneStart, index);
+    view_dispatcher_send_custom_event(app->view_dispatcher, COGSMyKaiCustomEventMenuSelected);
 }
 
 void cogs_mikai_scene_start_on_enter(void* context) {
@@ -36,6 +42,23 @@ void cogs_mikai_scene_start_on_enter(void* context) {
         cogs_mikai_scene_start_submenu_callback,
         app);
 
+    // Only the blocks that may have changed since the card in memory was read
+    if(app->mykey.is_loaded && !app->mykey.is_modified) {
+        submenu_add_item(
+            submenu,
+            "Re-read (Changes Only)",
+            SubmenuIndexReRead,
+            cogs_mikai_scene_start_submenu_callback,
+            app);
+    }
+
+    submenu_add_item(
+        submenu,
+        "Scan (Tap to View)",
+        SubmenuIndexScan,
+        cogs_mikai_scene_start_submenu_callback,
+        app);
+
     submenu_add_item(
         submenu,
         "View Info",
@@ -95,6 +118,20 @@ void cogs_mikai_scene_start_on_enter(void* context) {
         cogs_mikai_scene_start_submenu_callback,
         app);
 
+    submenu_add_item(
+        submenu,
+        app->debug_log.enabled ? "Debug Log: ON" : "Debug Log: OFF",
+        SubmenuIndexDebugLog,
+        cogs_mikai_scene_start_submenu_callback,
+        app);
+
+    submenu_add_item(
+        submenu,
+        app->trace_capture ? "Trace Capture: ON" : "Trace Capture: OFF",
+        SubmenuIndexTraceCapture,
+        cogs_mikai_scene_start_submenu_callback,
+        app);
+
     submenu_add_item(
         submenu,
         "About",
@@ -112,13 +149,24 @@ bool cogs_mikai_scene_start_on_event(void* context, SceneManagerEvent event) {
     COGSMyKaiApp* app = context;
     bool consumed = false;
 
-    if(event.type == SceneManagerEventTypeCustom) {
-        scene_manager_set_scene_state(app->scene_manager, COGSMyKaiSceneStart, event.event);
+    // Events left over from the scene just exited are not menu choices
+    if(event.type == SceneManagerEventTypeCustom &&
+       event.event == COGSMyKaiCustomEventMenuSelected) {
         consumed = true;
-        switch(event.event) {
+        switch(scene_manager_get_scene_state(app->scene_manager, COGSMyKaiSceneStart)) {
             case SubmenuIndexRead:
+                scene_manager_set_scene_state(
+                    app->scene_manager, COGSMyKaiSceneRead, MyKeyReadModeFull);
+                scene_manager_next_scene(app->scene_manager, COGSMyKaiSceneRead);
+                break;
+            case SubmenuIndexReRead:
+                scene_manager_set_scene_state(
+                    app->scene_manager, COGSMyKaiSceneRead, MyKeyReadModeIncremental);
                 scene_manager_next_scene(app->scene_manager, COGSMyKaiSceneRead);
                 break;
+            case SubmenuIndexScan:
+                scene_manager_next_scene(app->scene_manager, COGSMyKaiSceneScan);
+                break;
             case SubmenuIndexInfo:
                 scene_manager_next_scene(app->scene_manager, COGSMyKaiSceneInfo);
                 break;
@@ -143,6 +191,24 @@ bool cogs_mikai_scene_start_on_event(void* context, SceneManagerEvent event) {
             case SubmenuIndexDebug:
                 scene_manager_next_scene(app->scene_manager, COGSMyKaiSceneDebug);
                 break;
+            case SubmenuIndexDebugLog: {
+                // Toggle in place, stay on the menu. Kept for the next launch.
+                app->debug_log.enabled = !app->debug_log.enabled;
+                MyKeySettings settings = {.debug_log = app->debug_log.enabled};
+                mykey_settings_save(&settings);
+                submenu_change_item_label(
+                    app->submenu,
+                    SubmenuIndexDebugLog,
+                    app->debug_log.enabled ? "Debug Log: ON" : "Debug Log: OFF");
+                break;
+            }
+            case SubmenuIndexTraceCapture:
+                app->trace_capture = !app->trace_capture;
+                submenu_change_item_label(
+                    app->submenu,
+                    SubmenuIndexTraceCapture,
+                    app->trace_capture ? "Trace Capture: ON" : "Trace Capture: OFF");
+                break;
             case SubmenuIndexAbout:
                 scene_manager_next_scene(app->scene_manager, COGSMyKaiSceneAbout);
                 break;
@@ -2,7 +2,7 @@
 
 static void cogs_mikai_scene_write_card_popup_callback(void* context) {
     COGSMyKaiApp* app = context;
-    view_dispatcher_send_custom_event(app->view_dispatcher, 0);
+    view_dispatcher_send_custom_event(app->view_dispatcher, COGSMyKaiCustomEventPopupClosed);
 }
 
 void cogs_mikai_scene_write_card_on_enter(void* context) {
@@ -60,7 +60,8 @@ bool cogs_mikai_scene_write_card_on_event(void* context, SceneManagerEvent event
     COGSMyKaiApp* app = context;
     bool consumed = false;
 
-    if(event.type == SceneManagerEventTypeCustom) {
+    if(event.type == SceneManagerEventTypeCustom &&
+       event.event == COGSMyKaiCustomEventPopupClosed) {
         scene_manager_search_and_switch_to_previous_scene(app->scene_manager, COGSMyKaiSceneStart);
         consumed = true;
     }
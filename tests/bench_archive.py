@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""
+Packed archive throughput on synthetic dumps: decode straight from the mapping
+(Archive.summarize) and the column-wise CSV write of parse_mykey_file --bulk.
+
+    python3 tests/bench_archive.py [-n DUMPS] [-t THREADS] [--rows] [--keep DIR]
+
+Every figure is the best of --repeat runs, so the archive is in the page cache.
+"""
+
+import argparse
+import os
+import sys
+import tempfile
+import time
+
+import numpy as np
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+import mykey_archive
+import mykey_native
+import parse_mykey_file
+
+def best_of(repeat, function):
+    """(best seconds, last result)"""
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        result = function()
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best, result
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark decoding a packed MyKey archive.")
+    parser.add_argument("-n", "--dumps", type=int, default=1_000_000, help="synthetic dumps to pack")
+    parser.add_argument("-t", "--threads", type=int, default=os.cpu_count() or 1, help="decode threads")
+    parser.add_argument("-r", "--repeat", type=int, default=3, help="runs per measurement")
+    parser.add_argument("--rows", action="store_true",
+                        help="also time the per-dump row dicts the file path writes, for comparison")
+    parser.add_argument("--keep", help="directory to leave the archive and CSV in")
+    args = parser.parse_args()
+
+    if not mykey_native.available():
+        print("Error: the native library is needed (see mykey_native.py)", file=sys.stderr)
+        sys.exit(1)
+
+    directory = args.keep or tempfile.mkdtemp()
+    path = os.path.join(directory, "bench.mykpack")
+    output = os.path.join(directory, "bench.csv")
+
+    rng = np.random.default_rng(0)
+    images = rng.integers(0, 1 << 32, size=(args.dumps, 128), dtype=np.uint32)
+    uids = rng.integers(0, 1 << 63, size=args.dumps, dtype=np.uint64)
+    keys = rng.integers(0, 1 << 32, size=args.dumps, dtype=np.uint32)
+    mykey_archive.pack(path, uids, keys, images)
+    del images
+    size = args.dumps * mykey_archive.IMAGE_SIZE
+
+    def decode():
+        with mykey_archive.Archive(path) as archive:
+            return archive.summarize(args.threads)
+
+    def columns():
+        return parse_mykey_file.archive_columns(path, args.threads)
+
+    def write():
+        parse_mykey_file.write_rows([], output, [parse_mykey_file.archive_columns(path, args.threads)])
+
+    print(f"{args.dumps} dumps, {size / 2**20:.0f} MiB of images, {args.threads} threads")
+    elapsed, _ = best_of(args.repeat, decode)
+    print(f"  summarize:       {elapsed:8.3f} s  {size / elapsed / 1e9:6.2f} GB/s  "
+          f"{args.dumps / elapsed / 1e6:6.2f} M dumps/s")
+    elapsed, _ = best_of(args.repeat, columns)
+    print(f"  + columns:       {elapsed:8.3f} s  {args.dumps / elapsed / 1e6:6.2f} M dumps/s")
+    elapsed, _ = best_of(args.repeat, write)
+    print(f"  + CSV write:     {elapsed:8.3f} s  {args.dumps / elapsed / 1e6:6.2f} M dumps/s "
+          f"({os.path.getsize(output) / 2**20:.0f} MiB)")
+
+    if args.rows:
+        def rows():
+            summary = decode()
+            files = [f"{path}#{i}" for i in range(len(summary))]
+            parse_mykey_file.write_rows(parse_mykey_file.summary_rows(files, summary), output)
+        elapsed, _ = best_of(args.repeat, rows)
+        print(f"  row dicts + CSV: {elapsed:8.3f} s  {args.dumps / elapsed / 1e6:6.2f} M dumps/s")
+
+    if not args.keep:
+        os.remove(path)
+        os.remove(output)
+        os.rmdir(directory)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""
+Regenerate the synthetic trace fixtures: the reader's poller callback emulated
+over the host pipeline, with the card taken from card.txt.
+
+    python3 tests/fixtures/make_traces.py
+
+Traces captured on a device go next to these as they are, see test_replay.py.
+"""
+
+import ctypes
+import os
+import sys
+
+import numpy as np
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.dirname(HERE))
+sys.path.insert(0, os.path.dirname(os.path.dirname(HERE)))
+
+import mykey_native
+import parse_mykey_file
+from test_pipeline import READ_BLOCK, PROGRESS, bind, swap
+
+OP = {name: i for i, name in enumerate(mykey_native.TRACE_OPS)}
+ST25TB_TYPE_X4K = 5
+ST25TB_ERROR_TIMEOUT = 7
+READ_US = 2100  # Per block read
+POLL_US = 10000  # Per empty poll
+POWER = (3950 << 32) | 62  # mV << 32 | mA
+
+class Recorder:
+    """mykey_reader_poller_callback over an image, optionally failing one read"""
+
+    def __init__(self, lib, mode, uid, image, fail_block=None, baseline=None):
+        self.lib = lib
+        self.mode = mode
+        self.uid = uid
+        self.image = image
+        self.fail_block = fail_block
+        self.baseline = baseline
+        self.records = []
+        self.flags = 0
+        self.now = 0
+        self.read_block = READ_BLOCK(self._read_block)
+        self.progress = PROGRESS(lambda context, pipeline: None)
+
+    def add(self, op, arg=0, error=0, data=0):
+        self.records.append((OP[op], arg, error, 0, self.now, data))
+
+    def _read_block(self, context, block_num, block):
+        self.now += READ_US
+        if block_num == self.fail_block:
+            self.fail_block = None  # Only the first attempt, the card comes back
+            self.add("read", block_num, ST25TB_ERROR_TIMEOUT)
+            return False
+        block[0] = swap(self.image[block_num])
+        self.add("read", block_num, 0, block[0])
+        return True
+
+    def record(self, sessions=3):
+        pipeline = mykey_native._Pipeline()
+        order = (ctypes.c_uint8 * 128)()
+        count = self.lib.mykey_pipeline_order(mykey_native.READ_MODES[self.mode], order)
+        if self.baseline is not None:
+            self.flags |= mykey_native.TRACE_FLAG_BASELINE
+            self.lib.mykey_pipeline_init_incremental(
+                ctypes.byref(pipeline), self.uid, self.baseline.ctypes.data_as(ctypes.POINTER(ctypes.c_uint32)))
+        else:
+            self.lib.mykey_pipeline_init(ctypes.byref(pipeline), self.uid)
+
+        for _ in range(sessions):
+            self.now += 5000
+            self.add("detect", ST25TB_TYPE_X4K, 0, self.uid)
+            if self.mode == "incremental":
+                done = self.lib.mykey_pipeline_run_incremental(
+                    ctypes.byref(pipeline), self.read_block, None, self.progress, None)
+            else:
+                done = self.lib.mykey_pipeline_run(
+                    ctypes.byref(pipeline), order, count, self.read_block, None, self.progress, None)
+            if done:
+                self.add("done", 0, 0, pipeline.stages)
+                self.now += 900
+                self.add("power", 0, 0, POWER)
+                break
+            # Card pulled away and put back
+            for _ in range(5):
+                self.now += POLL_US
+                self.add("absent", 0, ST25TB_ERROR_TIMEOUT, 1)
+        # Consecutive empty polls are one record on the device
+        return self.collapse()
+
+    def collapse(self):
+        records = []
+        for record in self.records:
+            if records and record[0] == OP["absent"] and records[-1][0] == OP["absent"]:
+                records[-1] = records[-1][:4] + (record[4], records[-1][5] + 1)
+            else:
+                records.append(record)
+        return records
+
+    def save(self, name):
+        records = np.array(self.record(), dtype=mykey_native.TRACE_RECORD_DTYPE)
+        header = np.zeros(1, dtype=mykey_native.TRACE_HEADER_DTYPE)
+        header["magic"] = mykey_native.TRACE_MAGIC
+        header["version"] = mykey_native.TRACE_VERSION
+        header["mode"] = mykey_native.READ_MODES[self.mode]
+        header["record_size"] = mykey_native.TRACE_RECORD_DTYPE.itemsize
+        header["flags"] = self.flags
+        header["count"] = len(records)
+        with open(os.path.join(HERE, name), "wb") as f:
+            f.write(header.tobytes() + records.tobytes())
+
+def main():
+    lib = bind(mykey_native.load())
+    _, uid, _, blocks = parse_mykey_file.read_dump(os.path.join(HERE, "card.txt"))
+    card = np.array([blocks[i] for i in range(128)], dtype=np.uint32)
+
+    # Card wobbled off the reader on the second block, the next session resumed
+    Recorder(lib, "full", uid, card, fail_block=0x18).save("full_interrupted.mktr")
+
+    # Re-read after a purchase: op counter up, credit and the history ring changed
+    spent = card.copy()
+    spent[0x12] = (card[0x12] & 0xFF000000) | ((card[0x12] + 1) & 0x00FFFFFF)
+    spent[0x21] ^= 0x00000032
+    spent[0x35] ^= 0x0000FFFF
+    Recorder(lib, "incremental", uid, spent, baseline=card).save("incremental.mktr")
+
+if __name__ == "__main__":
+    main()
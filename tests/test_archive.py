@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+Packed archive round trip: dumps in every format packed with mykey_archive.build,
+mapped, summarized and written must give the rows the per-file bulk path gives.
+
+Run from the repository root:  python3 -m unittest discover -s tests
+"""
+
+import contextlib
+import csv
+import io
+import os
+import sys
+import tempfile
+import unittest
+from unittest import mock
+
+import numpy as np
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+import mykey_native
+import parse_mykey_file
+from test_summarize import random_images
+
+def write_v1(f, uid, key, image):
+    f.write(f"COGES_MYKEY_V1\nUID: {uid:016X}\nENCRYPTION_KEY: {key:08X}\n")
+    for i, block in enumerate(image):
+        f.write(f"BLOCK_{i:03d}: {int(block):08X}\n")
+
+def write_raw(f, uid, key, image):
+    f.write(f"MyKey Raw Data Dump\nUID: {uid:016X}\nEncryption Key: 0x{key:08X}\n\n")
+    for i, block in enumerate(image):
+        f.write(f"Block 0x{i:02X}: 0x{int(block):08X}\n")
+    f.write("\n")
+
+def write_debug(f, uid, key, image):
+    f.write(f"=== DEBUG INFO ===\n\nUID: {uid:016X}\nEncryption Key: 0x{key:08X}\n\n")
+    f.write(f"--- Key Blocks ---\nBlock 0x06: 0x{int(image[6]):08X}\n\n--- Raw Data Dump ---\n")
+    for i, block in enumerate(image):
+        f.write(f"Block 0x{i:02X}: 0x{int(block):08X}\n")
+
+def read_csv(path):
+    with open(path, newline="") as f:
+        return list(csv.DictReader(f))
+
+class ArchiveRoundTripTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        if not mykey_native.available():
+            raise unittest.SkipTest("native library unavailable (no C compiler?)")
+        import mykey_archive
+        cls.archive = mykey_archive
+
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.dir = self.tmp.name
+        self.uids, self.keys, self.images = random_images(60, seed=35)
+        dumps = list(zip(self.uids.tolist(), self.keys.tolist(), self.images))
+
+        # One file per dump in each single-dump format, and a debug log of many
+        writers = (("myk", write_v1), ("txt", write_raw), ("txt", write_debug))
+        for i, (uid, key, image) in enumerate(dumps[:45]):
+            ext, writer = writers[i % len(writers)]
+            with open(os.path.join(self.dir, f"dump{i:02d}.{ext}"), "w") as f:
+                writer(f, uid, key, image)
+        with open(os.path.join(self.dir, "log.log"), "w") as f:
+            for uid, key, image in dumps[45:]:
+                write_raw(f, uid, key, image)
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def test_round_trip(self):
+        for jobs in (1, 2):
+            with self.subTest(jobs=jobs):
+                path = os.path.join(self.dir, f"dumps{jobs}.mykpack")
+                count, errors = self.archive.build([self.dir], path, jobs)
+                self.assertEqual((count, errors), (60, []))
+
+                with self.archive.Archive(path) as archive:
+                    self.assertEqual(len(archive), 60)
+                    # Files are packed in path order, that is the order they were written in
+                    self.assertTrue(np.array_equal(archive.images, self.images))
+                    self.assertTrue(np.array_equal(archive.index["uid"], self.uids))
+                    self.assertEqual(archive.find(self.uids[7]).tolist(), [7])
+                    summary = archive.summarize(threads=jobs)
+                expected = mykey_native.summarize(self.images, self.uids, self.keys)
+                self.assertTrue(np.array_equal(summary, expected))
+
+    def test_rows_match_per_file_path(self):
+        path = os.path.join(self.dir, "dumps.mykpack")
+        self.archive.build([self.dir], path)
+        files_csv = os.path.join(self.dir, "files.csv")
+        archive_csv = os.path.join(self.dir, "archive.csv")
+        with contextlib.redirect_stderr(io.StringIO()):
+            self.assertTrue(parse_mykey_file.run_bulk([self.dir], files_csv, 1))
+            self.assertTrue(parse_mykey_file.run_bulk([path], archive_csv, 1))
+
+        from_files = read_csv(files_csv)
+        from_archive = read_csv(archive_csv)
+        self.assertEqual(len(from_files), 60)
+        self.assertEqual([r["file"] for r in from_archive], [f"{path}#{i}" for i in range(60)])
+        for row in from_files + from_archive:
+            del row["file"]
+        self.assertEqual(from_files, from_archive)
+
+    def test_failed_write_leaves_nothing(self):
+        path = os.path.join(self.dir, "dumps.mykpack")
+        for write in (lambda: self.archive.build([self.dir], path),
+                      lambda: self.archive.pack(path, self.uids, self.keys, self.images)):
+            with mock.patch.object(self.archive, "_finish", side_effect=OSError("disk full")):
+                with self.assertRaises(OSError):
+                    write()
+            self.assertFalse(os.path.exists(path))
+            self.assertFalse(os.path.exists(path + ".tmp"))
+
+    def test_empty_archive(self):
+        path = os.path.join(self.dir, "empty.mykpack")
+        self.archive.pack(path, [], [], np.zeros((0, 128), dtype=np.uint32))
+        output = os.path.join(self.dir, "empty.csv")
+        with contextlib.redirect_stderr(io.StringIO()):
+            self.assertTrue(parse_mykey_file.run_bulk([path], output, 1))
+        self.assertEqual(read_csv(output), [])
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""
+Stack budget regressions, checked on the host against the budgets in cogs_mikai.h
+and the app stack in application.fam.
+
+Frame sizes and call edges come from gcc -fstack-usage -fcallgraph-info on the
+Furi-free core. arm-none-eabi-gcc for the Cortex-M4 is used when it is on the PATH
+(or named by ARM_CC), otherwise the host cc without the x86-64 red zone, which
+would hide the locals of leaf functions. Host frames are then an estimate of the
+device ones, not a bound.
+
+Run from the repository root:  python3 -m unittest discover -s tests
+"""
+
+import glob
+import os
+import platform
+import re
+import shutil
+import subprocess
+import tempfile
+import unittest
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# The core sources the app links, see application.fam
+CORE_SOURCES = ("mykey_codec.c", "mykey_pipeline.c", "mykey_trace.c")
+# Only built into the host library (mykey_native.py), never run on the device
+HOST_ONLY = re.compile(r"^mykey_trace_replay")
+# Card-sized state, larger than any frame budget: always heap allocated
+CARD_TYPES = ("MyKeyData", "MyKeyPipeline", "MyKeyTrace", "MyKeyReader")
+# Calls through a pointer: the reader's block and progress callbacks in nfc_srix.c
+INDIRECT = "__indirect_call"
+CORTEX_M4 = ["-mcpu=cortex-m4", "-mthumb", "-mfloat-abi=hard", "-mfpu=fpv4-sp-d16"]
+
+def header_define(name):
+    with open(os.path.join(ROOT, "cogs_mikai.h")) as f:
+        match = re.search(rf"^#define {name} (\d+)", f.read(), re.MULTILINE)
+    if not match:
+        raise AssertionError(f"{name} not defined in cogs_mikai.h")
+    return int(match.group(1))
+
+def app_stack_size():
+    with open(os.path.join(ROOT, "application.fam")) as f:
+        match = re.search(r"stack_size=(\d+)\s*\*\s*1024", f.read())
+    if not match:
+        raise AssertionError("stack_size not found in application.fam")
+    return int(match.group(1)) * 1024
+
+def compiler():
+    """(command, flags) closest to the device build"""
+    arm = os.environ.get("ARM_CC") or shutil.which("arm-none-eabi-gcc")
+    if arm:
+        return [arm, "-Os"] + CORTEX_M4
+    cc = [os.environ.get("CC", "cc"), "-O2"]
+    if platform.machine().lower() in ("x86_64", "amd64"):
+        cc.append("-mno-red-zone")
+    return cc
+
+def call_graph(sources, directory):
+    """({function: (bytes, qualifiers)}, {function: callees}) from gcc -fcallgraph-info=su"""
+    frames, calls = {}, {}
+    for source in sources:
+        name = os.path.splitext(os.path.basename(source))[0]
+        subprocess.run(compiler() + ["-fstack-usage", "-fcallgraph-info=su", "-c", source,
+                                     "-o", os.path.join(directory, name + ".o")],
+                       check=True, cwd=directory, capture_output=True)
+        with open(os.path.join(directory, name + ".ci")) as f:
+            for line in f:
+                # Static functions are titled "file:function", externals just "function"
+                node = re.match(r'node: \{ title: "(?:[^"]*:)?(\w+)" label: "[^"]*\\n(\d+) bytes \(([^)]*)\)"', line)
+                if node:
+                    frames[node.group(1)] = (int(node.group(2)), node.group(3))
+                edge = re.match(r'edge: \{ sourcename: "(?:[^"]*:)?(\w+)" targetname: "(?:[^"]*:)?(\w+)"', line)
+                if edge:
+                    calls.setdefault(edge.group(1), set()).add(edge.group(2))
+    return frames, calls
+
+def deepest_chain(function, frames, calls, indirect_frame, path=()):
+    """(bytes, [functions]) of the deepest call chain from function"""
+    if function in path:
+        raise AssertionError(f"recursion: {' -> '.join(path + (function,))}")
+    if function == INDIRECT:
+        return indirect_frame, [INDIRECT]
+    if function not in frames:
+        return 0, []  # libc, no frame worth counting
+    best = (0, [])
+    for callee in calls.get(function, ()):
+        best = max(best, deepest_chain(callee, frames, calls, indirect_frame, path + (function,)))
+    return frames[function][0] + best[0], [function] + best[1]
+
+class StackBudgetTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        with tempfile.TemporaryDirectory() as directory:
+            try:
+                frames, calls = call_graph([os.path.join(ROOT, s) for s in CORE_SOURCES], directory)
+            except (OSError, subprocess.CalledProcessError) as e:
+                raise unittest.SkipTest(f"cannot compile with -fcallgraph-info: {e}")
+        cls.frames = {f: u for f, u in frames.items() if not HOST_ONLY.match(f)}
+        cls.calls = calls
+
+    def test_core_frames_within_budget(self):
+        budget = header_define("MYKEY_STACK_FRAME_BUDGET")
+        self.assertTrue(self.frames)
+        for function, (size, qualifiers) in sorted(self.frames.items()):
+            with self.subTest(function=function):
+                self.assertNotIn("unbounded", qualifiers)
+                self.assertLessEqual(size, budget, f"{function} uses {size} bytes of stack")
+
+    def test_frames_are_not_under_reported(self):
+        # 16 bytes of locals (listed[4]), a red zone would report 8
+        self.assertGreaterEqual(self.frames["mykey_pipeline_order"][0], 16)
+
+    def test_card_state_not_on_stack(self):
+        # A local card copy alone would eat most of the free-stack budget
+        declaration = re.compile(rf"^\s+(?:const\s+)?({'|'.join(CARD_TYPES)})\s+\w+(\[.*\])?\s*[;=]",
+                                 re.MULTILINE)
+        sources = glob.glob(os.path.join(ROOT, "*.c")) + glob.glob(os.path.join(ROOT, "scenes", "*.c"))
+        for source in sources:
+            with open(source) as f:
+                text = f.read()
+            for match in declaration.finditer(text):
+                line = text.count("\n", 0, match.start()) + 1
+                self.fail(f"{os.path.relpath(source, ROOT)}:{line}: {match.group(1)} on the stack")
+
+    def test_app_stack_covers_deepest_chain(self):
+        # Each callback and the scene or worker frame that calls into the core count as
+        # one budget-sized frame, and the free stack a scene keeps must remain
+        frame_budget = header_define("MYKEY_STACK_FRAME_BUDGET")
+        chain = max(deepest_chain(f, self.frames, self.calls, frame_budget) for f in self.frames)
+        needed = chain[0] + frame_budget + header_define("MYKEY_MEMSTAT_STACK_BUDGET")
+        self.assertLessEqual(needed, app_stack_size(),
+                             f"{' -> '.join(chain[1])}: {chain[0]} bytes")
+
+if __name__ == "__main__":
+    unittest.main()
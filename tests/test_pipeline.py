@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""
+Read pipeline (mykey_pipeline.c) driven through the host library: stage order,
+resuming an interrupted read, incremental re-reads, and decode results against the codec.
+
+Run from the repository root:  python3 -m unittest discover -s tests
+"""
+
+import ctypes
+import os
+import sys
+import unittest
+
+import numpy as np
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+import mykey_native
+
+KEY = 1 << 0
+CREDIT = 1 << 1
+INFO = 1 << 2
+COMPLETE = 1 << 3
+
+# Change markers and the blocks a transaction may change, see mykey_pipeline.c
+MARKERS = [0x12, 0x3C, 0x21]
+VOLATILE = [0x05, 0x06] + list(range(0x22, 0x28)) + list(range(0x34, 0x3C))
+
+READ_BLOCK = ctypes.CFUNCTYPE(ctypes.c_bool, ctypes.c_void_p, ctypes.c_uint8,
+                              ctypes.POINTER(ctypes.c_uint32))
+PROGRESS = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.POINTER(mykey_native._Pipeline))
+
+def bind(lib):
+    pipeline_p = ctypes.POINTER(mykey_native._Pipeline)
+    u8p = ctypes.POINTER(ctypes.c_uint8)
+    lib.mykey_pipeline_order.argtypes = [ctypes.c_int, u8p]
+    lib.mykey_pipeline_order.restype = ctypes.c_size_t
+    lib.mykey_pipeline_init.argtypes = [pipeline_p, ctypes.c_uint64]
+    lib.mykey_pipeline_init.restype = None
+    lib.mykey_pipeline_init_incremental.argtypes = [
+        pipeline_p, ctypes.c_uint64, ctypes.POINTER(ctypes.c_uint32)]
+    lib.mykey_pipeline_init_incremental.restype = None
+    lib.mykey_pipeline_incremental_planned.argtypes = [pipeline_p]
+    lib.mykey_pipeline_incremental_planned.restype = ctypes.c_size_t
+    lib.mykey_pipeline_feed.argtypes = [pipeline_p, ctypes.c_uint8, ctypes.c_uint32]
+    lib.mykey_pipeline_feed.restype = ctypes.c_uint32
+    lib.mykey_pipeline_run.argtypes = [
+        pipeline_p, u8p, ctypes.c_size_t, READ_BLOCK, ctypes.c_void_p, PROGRESS, ctypes.c_void_p]
+    lib.mykey_pipeline_run.restype = ctypes.c_bool
+    lib.mykey_pipeline_run_incremental.argtypes = [
+        pipeline_p, READ_BLOCK, ctypes.c_void_p, PROGRESS, ctypes.c_void_p]
+    lib.mykey_pipeline_run_incremental.restype = ctypes.c_bool
+    return lib
+
+def random_card(seed):
+    """A card image in the MyKeyData.eeprom layout and its UID"""
+    rng = np.random.default_rng(seed)
+    image = rng.integers(0, 1 << 32, size=128, dtype=np.uint64).astype(np.uint32)
+    uid = int(rng.integers(0, 1 << 63, dtype=np.uint64))
+    return uid, image
+
+def swap(value):
+    """eeprom order <-> as the poller returns the block"""
+    return int.from_bytes(int(value).to_bytes(4, "little"), "big")
+
+class Card:
+    """Pipeline transport over an image, logging reads and failing on request"""
+
+    def __init__(self, image, fail_at=None):
+        self.image = image
+        self.fail_at = fail_at  # Fail the n-th read
+        self.reads = []
+        self.progress = []  # (stages, block_count) per progress report
+        self.read_block = READ_BLOCK(self._read_block)
+        self.report = PROGRESS(self._report)
+
+    def _read_block(self, context, block_num, block):
+        self.reads.append(block_num)
+        if self.fail_at is not None and len(self.reads) - 1 == self.fail_at:
+            return False
+        block[0] = swap(self.image[block_num])
+        return True
+
+    def _report(self, context, pipeline):
+        self.progress.append((pipeline.contents.stages, pipeline.contents.block_count))
+
+class PipelineTestCase(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        if not mykey_native.available():
+            raise unittest.SkipTest("native library unavailable (no C compiler?)")
+        cls.lib = bind(mykey_native.load())
+
+    def order(self, mode):
+        order = (ctypes.c_uint8 * 128)()
+        count = self.lib.mykey_pipeline_order(mykey_native.READ_MODES[mode], order)
+        return order, count
+
+    def run_pipeline(self, pipeline, card, mode="full"):
+        order, count = self.order(mode)
+        return self.lib.mykey_pipeline_run(ctypes.byref(pipeline), order, count,
+                                           card.read_block, None, card.report, None)
+
+class PipelineStageTest(PipelineTestCase):
+    def test_stages_complete_in_order(self):
+        uid, image = random_card(1)
+        card = Card(image)
+        pipeline = mykey_native._Pipeline()
+        self.lib.mykey_pipeline_init(ctypes.byref(pipeline), uid)
+        self.assertTrue(self.run_pipeline(pipeline, card))
+
+        # Blocks at which each stage was first reported
+        reached = {}
+        for stages, block_count in card.progress:
+            for stage in (KEY, CREDIT, INFO, COMPLETE):
+                if stages & stage and stage not in reached:
+                    reached[stage] = block_count
+        self.assertEqual(reached, {KEY: 3, CREDIT: 4, INFO: 15, COMPLETE: 128})
+        # Stages only ever accumulate
+        for (before, _), (after, _) in zip(card.progress, card.progress[1:]):
+            self.assertEqual(before & after, before)
+
+        self.assertEqual(card.reads[:4], [0x06, 0x18, 0x19, 0x21])
+        self.assertEqual(sorted(card.reads), list(range(128)))
+        self.assertEqual(pipeline.encryption_key, mykey_native.encryption_key(uid, image))
+        summary = mykey_native.summarize(image[None, :], [uid])[0]
+        self.assertEqual(pipeline.credit, summary["credit"])
+        self.assertTrue(np.array_equal(np.array(pipeline.eeprom, dtype=np.uint32), image))
+
+    def test_quick_mode_stops_at_info(self):
+        uid, image = random_card(2)
+        card = Card(image)
+        pipeline = mykey_native._Pipeline()
+        self.lib.mykey_pipeline_init(ctypes.byref(pipeline), uid)
+        self.assertTrue(self.run_pipeline(pipeline, card, "quick"))
+        self.assertEqual(len(card.reads), 15)
+        self.assertEqual(pipeline.stages, KEY | CREDIT | INFO | COMPLETE)
+
+    def test_feed_reports_new_stages(self):
+        uid, image = random_card(3)
+        pipeline = mykey_native._Pipeline()
+        self.lib.mykey_pipeline_init(ctypes.byref(pipeline), uid)
+        feed = lambda block: self.lib.mykey_pipeline_feed(ctypes.byref(pipeline), block,
+                                                          swap(image[block]))
+
+        # Credit needs the key, it comes in with the last key block
+        self.assertEqual(feed(0x21), 0)
+        self.assertEqual(feed(0x06), 0)
+        self.assertEqual(feed(0x18), 0)
+        self.assertEqual(feed(0x19), KEY | CREDIT)
+        self.assertEqual(feed(0x19), 0)  # Nothing new on a repeated block
+        for block in (0x07, 0x12, 0x3C, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A):
+            self.assertEqual(feed(block), 0)
+        self.assertEqual(feed(0x3B), INFO)
+        self.assertEqual(pipeline.block_count, 15)
+        self.assertFalse(pipeline.stages & COMPLETE)
+
+    def test_interrupted_read_resumes(self):
+        uid, image = random_card(4)
+        pipeline = mykey_native._Pipeline()
+        self.lib.mykey_pipeline_init(ctypes.byref(pipeline), uid)
+
+        first = Card(image, fail_at=40)
+        self.assertFalse(self.run_pipeline(pipeline, first))
+        self.assertEqual(pipeline.block_count, 40)
+        self.assertFalse(pipeline.stages & COMPLETE)
+
+        # The same card back in the field: only what is missing is fetched
+        second = Card(image)
+        self.assertTrue(self.run_pipeline(pipeline, second))
+        self.assertEqual(len(second.reads), 88)
+        self.assertFalse(set(first.reads[:40]) & set(second.reads))
+        self.assertTrue(np.array_equal(np.array(pipeline.eeprom, dtype=np.uint32), image))
+
+class PipelineIncrementalTest(PipelineTestCase):
+    def reread(self, uid, baseline, image):
+        card = Card(image)
+        pipeline = mykey_native._Pipeline()
+        baseline = np.ascontiguousarray(baseline, dtype=np.uint32)
+        self.lib.mykey_pipeline_init_incremental(
+            ctypes.byref(pipeline), uid, baseline.ctypes.data_as(ctypes.POINTER(ctypes.c_uint32)))
+        self.assertTrue(self.lib.mykey_pipeline_run_incremental(
+            ctypes.byref(pipeline), card.read_block, None, card.report, None))
+        self.assertTrue(pipeline.stages & COMPLETE)
+        self.assertTrue(np.array_equal(np.array(pipeline.eeprom, dtype=np.uint32), image))
+        # The progress view's total, once the markers are in
+        self.assertEqual(self.lib.mykey_pipeline_incremental_planned(ctypes.byref(pipeline)),
+                         len(card.reads))
+        return pipeline, card
+
+    def test_planned_before_markers(self):
+        uid, baseline = random_card(14)
+        pipeline = mykey_native._Pipeline()
+        self.lib.mykey_pipeline_init(ctypes.byref(pipeline), uid)
+        self.assertEqual(self.lib.mykey_pipeline_incremental_planned(ctypes.byref(pipeline)), 128)
+        self.lib.mykey_pipeline_init_incremental(
+            ctypes.byref(pipeline), uid, baseline.ctypes.data_as(ctypes.POINTER(ctypes.c_uint32)))
+        self.assertEqual(self.lib.mykey_pipeline_incremental_planned(ctypes.byref(pipeline)),
+                         len(MARKERS + VOLATILE))
+
+    def test_markers_unchanged(self):
+        uid, baseline = random_card(10)
+        pipeline, card = self.reread(uid, baseline, baseline.copy())
+        self.assertEqual(sorted(card.reads), sorted(MARKERS))
+        self.assertEqual(pipeline.changed_count, 0)
+
+    def test_markers_moved_forward(self):
+        uid, baseline = random_card(11)
+        image = baseline.copy()
+        # A transaction: op counter up, new credit, a history slot and a transaction block
+        image[0x12] = (baseline[0x12] & 0xFF000000) | ((baseline[0x12] + 1) & 0x00FFFFFF)
+        image[0x21] ^= 0x1
+        image[0x35] ^= 0xFFFF
+        image[0x23] ^= 0x10
+        pipeline, card = self.reread(uid, baseline, image)
+        self.assertEqual(sorted(card.reads), sorted(MARKERS + VOLATILE))
+        self.assertEqual(pipeline.changed_count, 4)
+
+    def test_op_counter_went_backwards(self):
+        uid, baseline = random_card(12)
+        baseline[0x12] = (baseline[0x12] & 0xFF000000) | 0x100
+        image = random_card(13)[1]
+        image[0x12] = (image[0x12] & 0xFF000000) | 0x0FF
+        # Reset or rewritten: everything is fetched again
+        pipeline, card = self.reread(uid, baseline, image)
+        self.assertEqual(sorted(card.reads), list(range(128)))
+        self.assertEqual(pipeline.block_count, 128)
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+Bulk decode parity: the scalar, numpy and native summarize paths must produce
+identical rows for the same dumps.
+
+Run from the repository root:  python3 -m unittest discover -s tests
+"""
+
+import ctypes
+import os
+import sys
+import tempfile
+import unittest
+from unittest import mock
+
+import numpy as np
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+import mykey_native
+import parse_mykey_file
+
+IMAGES = 2000
+
+def random_images(count, seed=0x4D794B):
+    """Random dumps, with enough structure to reach every branch of the summary"""
+    rng = np.random.default_rng(seed)
+    images = rng.integers(0, 1 << 32, size=(count, 128), dtype=np.uint64).astype(np.uint32)
+    uids = rng.integers(0, 1 << 63, size=count, dtype=np.uint64)
+    keys = rng.integers(0, 1 << 32, size=count, dtype=np.uint64).astype(np.uint32)
+
+    # Reset cards
+    reset = rng.random(count) < 0.1
+    images[reset, 0x18] = 0x8FCD0F48
+    images[reset, 0x19] = 0xC0820007
+    # No history, and history rings with empty slots
+    images[rng.random(count) < 0.1, 0x3C] = 0xFFFFFFFF
+    images[:, 0x34:0x3C][rng.random((count, 8)) < 0.2] = 0xFFFFFFFF
+    return uids, keys, images
+
+class SummarizeParityTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        if not mykey_native.available():
+            raise unittest.SkipTest("native library unavailable (no C compiler?)")
+        cls.uids, cls.keys, cls.images = random_images(IMAGES)
+        cls.files = [f"dump{i}" for i in range(IMAGES)]
+
+    def test_batch_matches_scalar(self):
+        scalar = [parse_mykey_file.summarize(f, int(u), int(k), dict(enumerate(int(b) for b in image)))
+                  for f, u, k, image in zip(self.files, self.uids, self.keys, self.images)]
+        batch = parse_mykey_file.summarize_batch(self.files, self.uids, self.keys, self.images)
+        self.assertEqual(scalar, batch)
+
+    def test_native_matches_batch(self):
+        batch = parse_mykey_file.summarize_batch(self.files, self.uids, self.keys, self.images)
+        native = parse_mykey_file.summarize_native(self.files, self.uids, self.keys, self.images)
+        self.assertEqual(batch, native)
+
+    def test_native_threads_match(self):
+        single = mykey_native.summarize(self.images, self.uids, self.keys)
+        threaded = mykey_native.summarize(self.images, self.uids, self.keys, threads=4)
+        self.assertTrue(np.array_equal(single, threaded))
+
+class NativeBuildTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        if not mykey_native.available():
+            raise unittest.SkipTest("native library unavailable (no C compiler?)")
+
+    def test_summary_dtype_matches_c(self):
+        lib = mykey_native.load()
+        self.assertEqual(mykey_native.SUMMARY_DTYPE.itemsize,
+                         ctypes.c_size_t.in_dll(lib, "mykey_codec_summary_size").value)
+
+    def test_header_change_rebuilds(self):
+        with tempfile.TemporaryDirectory() as directory:
+            library = os.path.join(directory, "libmykey_codec.so")
+            header = os.path.join(directory, "changed.h")
+            open(header, "w").close()
+            environ = {k: v for k, v in os.environ.items() if k != "MYKEY_CODEC_LIB"}
+            with mock.patch.dict(os.environ, environ, clear=True), \
+                 mock.patch.multiple(mykey_native, LIBRARY=library,
+                                     HEADERS=mykey_native.HEADERS + [header]):
+                mykey_native._build()
+                built = os.path.getmtime(library)
+                mykey_native._build()
+                self.assertEqual(os.path.getmtime(library), built)
+
+                # A header newer than the library: stale layouts, build again
+                os.utime(header, (built + 60, built + 60))
+                mykey_native._build()
+                self.assertGreater(os.path.getmtime(library), built)
+
+if __name__ == "__main__":
+    unittest.main()